@@ -33,8 +33,8 @@
 
 A3_INLINE a3ret a3hierarchyIsParentNode(const a3_Hierarchy *hierarchy, const a3ui32 parentIndex, const a3ui32 otherIndex)
 {
-	if (hierarchy && hierarchy->nodes && otherIndex < hierarchy->numNodes && parentIndex < hierarchy->numNodes)
-		return (hierarchy->nodes[otherIndex].parentIndex == parentIndex);
+	if (hierarchy && hierarchy->parentIndex && otherIndex < hierarchy->numNodes && parentIndex < hierarchy->numNodes)
+		return (hierarchy->parentIndex[otherIndex] == (a3i32)parentIndex);
 	return -1;
 }
 
@@ -45,18 +45,18 @@ A3_INLINE a3ret a3hierarchyIsChildNode(const a3_Hierarchy *hierarchy, const a3ui
 
 A3_INLINE a3ret a3hierarchyIsSiblingNode(const a3_Hierarchy *hierarchy, const a3ui32 siblingIndex, const a3ui32 otherIndex)
 {
-	if (hierarchy && hierarchy->nodes && otherIndex < hierarchy->numNodes && siblingIndex < hierarchy->numNodes)
-		return (hierarchy->nodes[otherIndex].parentIndex == hierarchy->nodes[siblingIndex].parentIndex);
+	if (hierarchy && hierarchy->parentIndex && otherIndex < hierarchy->numNodes && siblingIndex < hierarchy->numNodes)
+		return (hierarchy->parentIndex[otherIndex] == hierarchy->parentIndex[siblingIndex]);
 	return -1;
 }
 
 A3_INLINE a3ret a3hierarchyIsAncestorNode(const a3_Hierarchy *hierarchy, const a3ui32 ancestorIndex, const a3ui32 otherIndex)
 {
 	a3ui32 i = otherIndex;
-	if (hierarchy && hierarchy->nodes && otherIndex < hierarchy->numNodes && ancestorIndex < hierarchy->numNodes)
+	if (hierarchy && hierarchy->parentIndex && otherIndex < hierarchy->numNodes && ancestorIndex < hierarchy->numNodes)
 	{
 		while (i > ancestorIndex)
-			i = hierarchy->nodes[i].parentIndex;
+			i = hierarchy->parentIndex[i];
 		return (i == ancestorIndex);
 	}
 	return -1;
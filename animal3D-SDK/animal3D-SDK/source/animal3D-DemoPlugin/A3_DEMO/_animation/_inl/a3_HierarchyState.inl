@@ -53,15 +53,324 @@ inline a3i32 a3hierarchyPoseGroupGetNodePoseOffsetIndex(const a3_HierarchyPoseGr
 
 //-----------------------------------------------------------------------------
 
+// reset full hierarchy pose
+inline a3i32 a3hierarchyPoseReset(const a3_HierarchyPose *pose_inout, const a3ui32 nodeCount)
+{
+	if (pose_inout && pose_inout->spatialPose)
+	{
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseReset(pose_inout->spatialPose + i);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// copy full hierarchy pose
+inline a3i32 a3hierarchyPoseCopy(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount)
+{
+	if (pose_out && pose_out->spatialPose && pose_in && pose_in->spatialPose)
+	{
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseCopy(pose_out->spatialPose + i, pose_in->spatialPose + i);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// convert full hierarchy pose to hierarchy transforms
+inline a3i32 a3hierarchyPoseConvert(const a3_HierarchyTransform *transform_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount)
+{
+	if (transform_out && transform_out->transform && pose_in && pose_in->spatialPose)
+	{
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseConvert(transform_out->transform + i, pose_in->spatialPose + i);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// concatenate full hierarchy poses
+inline a3i32 a3hierarchyPoseConcat(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_lhs, const a3_HierarchyPose *pose_rhs, const a3ui32 nodeCount, const a3_SpatialPoseChannel *channel)
+{
+	if (pose_out && pose_out->spatialPose && pose_lhs && pose_lhs->spatialPose && pose_rhs && pose_rhs->spatialPose && channel)
+	{
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseConcat(pose_out->spatialPose + i, pose_lhs->spatialPose + i, pose_rhs->spatialPose + i, channel[i]);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// interpolate full hierarchy poses
+inline a3i32 a3hierarchyPoseLerp(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose0, const a3_HierarchyPose *pose1, const a3ui32 nodeCount, const a3real u, const a3_SpatialPoseChannel *channel)
+{
+	if (pose_out && pose_out->spatialPose && pose0 && pose0->spatialPose && pose1 && pose1->spatialPose && channel)
+	{
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseLerp(pose_out->spatialPose + i, pose0->spatialPose + i, pose1->spatialPose + i, u, channel[i]);
+		return nodeCount;
+	}
+	return -1;
+}
+
+
+// set full dual quaternion pose from hierarchy pose
+inline a3i32 a3hierarchyPoseDQSetPose(const a3_HierarchyPoseDQ *pose_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount)
+{
+	if (pose_out && pose_out->spatialPose && pose_in && pose_in->spatialPose)
+	{
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseDQSetPose(pose_out->spatialPose + i, pose_in->spatialPose + i);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// convert full dual quaternion pose to hierarchy transforms
+inline a3i32 a3hierarchyPoseDQConvert(const a3_HierarchyTransform *transform_out, const a3_HierarchyPoseDQ *pose_in, const a3ui32 nodeCount)
+{
+	if (transform_out && transform_out->transform && pose_in && pose_in->spatialPose)
+	{
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseDQConvert(transform_out->transform + i, pose_in->spatialPose + i);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// interpolate full dual quaternion poses
+inline a3i32 a3hierarchyPoseDQLerp(const a3_HierarchyPoseDQ *pose_out, const a3_HierarchyPoseDQ *pose0, const a3_HierarchyPoseDQ *pose1, const a3ui32 nodeCount, const a3real u)
+{
+	if (pose_out && pose_out->spatialPose && pose0 && pose0->spatialPose && pose1 && pose1->spatialPose)
+	{
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseDQLerp(pose_out->spatialPose + i, pose0->spatialPose + i, pose1->spatialPose + i, u);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// calculate bind-to-current dual quaternions
+inline a3i32 a3hierarchyPoseDQGetBindToCurrent(const a3_HierarchyPoseDQ *pose_out, const a3_HierarchyPoseDQ *objectPose, const a3_HierarchyPoseDQ *objectBindInverse, const a3ui32 nodeCount)
+{
+	if (pose_out && pose_out->spatialPose && objectPose && objectPose->spatialPose && objectBindInverse && objectBindInverse->spatialPose)
+	{
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseDQConcat(pose_out->spatialPose + i, objectPose->spatialPose + i, objectBindInverse->spatialPose + i);
+		return nodeCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// get number of nodes evaluated at the current detail level
+inline a3i32 a3hierarchyStateGetActiveNodeCount(const a3_HierarchyState *state)
+{
+	if (state && state->poseGroup)
+		return state->poseGroup->hierarchy->lodNodeCount[state->lod];
+	return -1;
+}
+
+// set scale mode
+inline a3i32 a3hierarchyStateSetScaleMode(a3_HierarchyState *state, const a3_HierarchyStateScaleMode scaleMode)
+{
+	if (state && scaleMode <= a3hierarchyStateScale_full)
+	{
+		state->scaleMode = scaleMode;
+		return scaleMode;
+	}
+	return -1;
+}
+
+// mark node and its descendants dirty
+inline a3i32 a3hierarchyStateMarkDirty(const a3_HierarchyState *state, const a3ui32 nodeIndex)
+{
+	if (state && state->poseGroup && nodeIndex < state->poseGroup->hierarchy->numNodes)
+	{
+		// descendants always follow their parents, and the set of nodes 
+		//	needing FK is closed over children, so one forward pass over the 
+		//	topology is enough to propagate
+		const a3i16 *parentIndex = state->poseGroup->hierarchy->parentIndex;
+		a3ubyte *dirty = state->nodeDirty;
+		const a3ui32 count = state->poseGroup->hierarchy->numNodes;
+		a3ui32 i;
+		dirty[nodeIndex] = a3hierarchyStateDirty_all;
+		for (i = nodeIndex + 1; i < count; ++i)
+			if (parentIndex[i] >= (a3i32)nodeIndex && (dirty[parentIndex[i]] & a3hierarchyStateDirty_object))
+				dirty[i] = a3hierarchyStateDirty_all;
+		return nodeIndex;
+	}
+	return -1;
+}
+
+// mark all nodes dirty
+inline a3i32 a3hierarchyStateMarkDirtyAll(const a3_HierarchyState *state)
+{
+	if (state && state->poseGroup)
+	{
+		const a3ui32 count = state->poseGroup->hierarchy->numNodes;
+		a3ui32 i;
+		for (i = 0; i < count; ++i)
+			state->nodeDirty[i] = a3hierarchyStateDirty_all;
+		return count;
+	}
+	return -1;
+}
+
+// convert sampled poses of dirty nodes to local-space matrices
+inline a3i32 a3hierarchyStateUpdateLocalSpace(const a3_HierarchyState *state)
+{
+	if (state && state->poseGroup)
+	{
+		const a3_SpatialPose *pose = state->samplePose->spatialPose;
+		a3mat4 *m = state->localSpace->transform;
+		const a3ubyte *dirty = state->nodeDirty;
+		const a3ui32 count = state->poseGroup->hierarchy->lodNodeCount[state->lod];
+		a3ui32 i, updated = 0;
+		for (i = 0; i < count; ++i)
+			if (dirty[i] & a3hierarchyStateDirty_object)
+			{
+				a3spatialPoseConvert(m + i, pose + i);
+				++updated;
+			}
+		return updated;
+	}
+	return -1;
+}
+
+// invert an object-space matrix as the scale mode allows: rigid and 
+//	uniformly scaled bases are transposed (and divided by the squared 
+//	scale); non-uniform scale shears once concatenated, so it takes the 
+//	general affine inverse
+inline void a3hierarchyStateInternalInvert(a3mat4 *mInv, const a3mat4 *m, const a3_HierarchyStateScaleMode scaleMode)
+{
+	a3real s = a3real_one;
+	if (scaleMode == a3hierarchyStateScale_full)
+	{
+		a3real4x4TransformInverse(mInv->m, m->m);
+		return;
+	}
+	if (scaleMode == a3hierarchyStateScale_uniform)
+		s = a3recip(m->m00 * m->m00 + m->m01 * m->m01 + m->m02 * m->m02);
+
+	// transpose basis
+	mInv->m00 = m->m00 * s;
+	mInv->m01 = m->m10 * s;
+	mInv->m02 = m->m20 * s;
+	mInv->m10 = m->m01 * s;
+	mInv->m11 = m->m11 * s;
+	mInv->m12 = m->m21 * s;
+	mInv->m20 = m->m02 * s;
+	mInv->m21 = m->m12 * s;
+	mInv->m22 = m->m22 * s;
+
+	// negate translation and rotate into inverse basis
+	mInv->m30 = -(m->m00 * m->m30 + m->m01 * m->m31 + m->m02 * m->m32) * s;
+	mInv->m31 = -(m->m10 * m->m30 + m->m11 * m->m31 + m->m12 * m->m32) * s;
+	mInv->m32 = -(m->m20 * m->m30 + m->m21 * m->m31 + m->m22 * m->m32) * s;
+
+	// affine bottom row
+	mInv->m03 = mInv->m13 = mInv->m23 = a3real_zero;
+	mInv->m33 = a3real_one;
+}
+
 // update inverse object-space matrices
-inline a3i32 a3hierarchyStateUpdateObjectInverse(const a3_HierarchyState *state, const a3boolean usingScale)
+inline a3i32 a3hierarchyStateUpdateObjectInverse(const a3_HierarchyState *state)
 {
+	if (state && state->poseGroup)
+	{
+		const a3mat4 *m = state->objectSpace->transform;
+		a3mat4 *mInv = state->objectSpaceInverse->transform;
+		a3ubyte *dirty = state->nodeDirty;
+		const a3ui32 count = state->poseGroup->hierarchy->lodNodeCount[state->lod];
+		a3ui32 i, updated = 0;
+		for (i = 0; i < count; ++i, ++m, ++mInv, ++dirty)
+		{
+			// skip clean nodes and nodes still waiting on FK
+			if ((*dirty & (a3hierarchyStateDirty_object | a3hierarchyStateDirty_objectInverse)) != a3hierarchyStateDirty_objectInverse)
+				continue;
+			*dirty &= ~a3hierarchyStateDirty_objectInverse;
+			++updated;
+			a3hierarchyStateInternalInvert(mInv, m, state->scaleMode);
+		}
+		return updated;
+	}
 	return -1;
 }
 
 // update bind-to-current given bind-pose object-space transforms
 inline a3i32 a3hierarchyStateUpdateObjectBindToCurrent(const a3_HierarchyState *state, const a3_HierarchyTransform *objectSpaceBindInverse)
 {
+	if (state && state->poseGroup && objectSpaceBindInverse && objectSpaceBindInverse->transform)
+	{
+		const a3mat4 *mL = state->objectSpace->transform;
+		const a3mat4 *mR = objectSpaceBindInverse->transform;
+		a3mat4 *m = state->objectSpaceBindToCurrent->transform;
+		a3ubyte *dirty = state->nodeDirty;
+		const a3i16 *parentIndex = state->poseGroup->hierarchy->parentIndex;
+		const a3ui32 count = state->poseGroup->hierarchy->lodNodeCount[state->lod];
+		const a3ui32 total = state->poseGroup->hierarchy->numNodes;
+		a3ui32 i, updated = 0;
+		a3i32 j;
+		for (i = 0; i < count; ++i, ++mL, ++mR, ++m, ++dirty)
+		{
+			// skip clean nodes and nodes still waiting on FK
+			if ((*dirty & (a3hierarchyStateDirty_object | a3hierarchyStateDirty_objectBindToCurrent)) != a3hierarchyStateDirty_objectBindToCurrent)
+				continue;
+			*dirty &= ~a3hierarchyStateDirty_objectBindToCurrent;
+			++updated;
+
+			// bind-to-current = current object * inverse bind object
+			// both are affine, so only the upper 3 rows are multiplied
+			m->m00 = mL->m00 * mR->m00 + mL->m10 * mR->m01 + mL->m20 * mR->m02;
+			m->m01 = mL->m01 * mR->m00 + mL->m11 * mR->m01 + mL->m21 * mR->m02;
+			m->m02 = mL->m02 * mR->m00 + mL->m12 * mR->m01 + mL->m22 * mR->m02;
+			m->m10 = mL->m00 * mR->m10 + mL->m10 * mR->m11 + mL->m20 * mR->m12;
+			m->m11 = mL->m01 * mR->m10 + mL->m11 * mR->m11 + mL->m21 * mR->m12;
+			m->m12 = mL->m02 * mR->m10 + mL->m12 * mR->m11 + mL->m22 * mR->m12;
+			m->m20 = mL->m00 * mR->m20 + mL->m10 * mR->m21 + mL->m20 * mR->m22;
+			m->m21 = mL->m01 * mR->m20 + mL->m11 * mR->m21 + mL->m21 * mR->m22;
+			m->m22 = mL->m02 * mR->m20 + mL->m12 * mR->m21 + mL->m22 * mR->m22;
+			m->m30 = mL->m00 * mR->m30 + mL->m10 * mR->m31 + mL->m20 * mR->m32 + mL->m30;
+			m->m31 = mL->m01 * mR->m30 + mL->m11 * mR->m31 + mL->m21 * mR->m32 + mL->m31;
+			m->m32 = mL->m02 * mR->m30 + mL->m12 * mR->m31 + mL->m22 * mR->m32 + mL->m32;
+			m->m03 = m->m13 = m->m23 = a3real_zero;
+			m->m33 = a3real_one;
+		}
+
+		// culled nodes keep their bind pose relative to their parent, so they 
+		//	take the parent's skinning matrix (identity for a root); parents 
+		//	come first, so a culled parent is already resolved here, and a 
+		//	child of a node still waiting on FK stays dirty to follow it later
+		for (; i < total; ++i, ++m, ++dirty)
+		{
+			if (!(*dirty & a3hierarchyStateDirty_objectBindToCurrent))
+				continue;
+			j = parentIndex[i];
+			if (j >= 0)
+			{
+				*m = state->objectSpaceBindToCurrent->transform[j];
+				if (state->nodeDirty[j] & a3hierarchyStateDirty_objectBindToCurrent)
+					continue;
+			}
+			else
+				a3real4x4SetIdentity(m->m);
+			*dirty &= ~a3hierarchyStateDirty_objectBindToCurrent;
+			++updated;
+		}
+		return updated;
+	}
 	return -1;
 }
 
@@ -30,6 +30,510 @@
 
 //-----------------------------------------------------------------------------
 
+// weighted sum of 4 orientations, each flipped onto the hemisphere of the 
+//	first, then normalized; unused inputs take zero weight
+inline void a3spatialPoseInternalSumOrient(a3vec4 *q_out, const a3vec4 *q0, const a3vec4 *q1, const a3vec4 *q2, const a3vec4 *q3, 
+	const a3real w0, const a3real w1, const a3real w2, const a3real w3)
+{
+	const a3real s1 = (q0->x * q1->x + q0->y * q1->y + q0->z * q1->z + q0->w * q1->w) < a3real_zero ? -w1 : w1;
+	const a3real s2 = (q0->x * q2->x + q0->y * q2->y + q0->z * q2->z + q0->w * q2->w) < a3real_zero ? -w2 : w2;
+	const a3real s3 = (q0->x * q3->x + q0->y * q3->y + q0->z * q3->z + q0->w * q3->w) < a3real_zero ? -w3 : w3;
+	const a3real x = q0->x * w0 + q1->x * s1 + q2->x * s2 + q3->x * s3;
+	const a3real y = q0->y * w0 + q1->y * s1 + q2->y * s2 + q3->y * s3;
+	const a3real z = q0->z * w0 + q1->z * s1 + q2->z * s2 + q3->z * s3;
+	const a3real w = q0->w * w0 + q1->w * s1 + q2->w * s2 + q3->w * s3;
+	const a3real lenInv = a3sqrtInverse(x * x + y * y + z * z + w * w);
+	q_out->x = x * lenInv;
+	q_out->y = y * lenInv;
+	q_out->z = z * lenInv;
+	q_out->w = w * lenInv;
+}
+
+// weighted sum of 4 vectors
+inline void a3spatialPoseInternalSumVec3(a3vec3 *v_out, const a3vec3 *v0, const a3vec3 *v1, const a3vec3 *v2, const a3vec3 *v3, 
+	const a3real w0, const a3real w1, const a3real w2, const a3real w3)
+{
+	const a3real x = v0->x * w0 + v1->x * w1 + v2->x * w2 + v3->x * w3;
+	const a3real y = v0->y * w0 + v1->y * w1 + v2->y * w2 + v3->y * w3;
+	const a3real z = v0->z * w0 + v1->z * w1 + v2->z * w2 + v3->z * w3;
+	v_out->x = x;
+	v_out->y = y;
+	v_out->z = z;
+}
+
+// weighted sum of 4 poses
+inline void a3spatialPoseInternalSum(a3_SpatialPose *pose_out, const a3_SpatialPose *p0, const a3_SpatialPose *p1, const a3_SpatialPose *p2, const a3_SpatialPose *p3, 
+	const a3real w0, const a3real w1, const a3real w2, const a3real w3)
+{
+	a3spatialPoseInternalSumOrient(&pose_out->orientation, &p0->orientation, &p1->orientation, &p2->orientation, &p3->orientation, w0, w1, w2, w3);
+	a3spatialPoseInternalSumVec3(&pose_out->scale, &p0->scale, &p1->scale, &p2->scale, &p3->scale, w0, w1, w2, w3);
+	a3spatialPoseInternalSumVec3(&pose_out->translation, &p0->translation, &p1->translation, &p2->translation, &p3->translation, w0, w1, w2, w3);
+}
+
+
+// identity kernel
+inline void a3spatialPoseInternalOpIdentity(a3_SpatialPose *pose_out)
+{
+	pose_out->orientation.x = pose_out->orientation.y = pose_out->orientation.z = a3real_zero;
+	pose_out->orientation.w = a3real_one;
+	pose_out->scale.x = pose_out->scale.y = pose_out->scale.z = a3real_one;
+	pose_out->translation.x = pose_out->translation.y = pose_out->translation.z = a3real_zero;
+}
+
+// negate kernel: conjugate, reciprocal scale, negative translation
+inline void a3spatialPoseInternalOpNegate(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_in)
+{
+	pose_out->orientation.x = -pose_in->orientation.x;
+	pose_out->orientation.y = -pose_in->orientation.y;
+	pose_out->orientation.z = -pose_in->orientation.z;
+	pose_out->orientation.w = pose_in->orientation.w;
+	pose_out->scale.x = a3recip(pose_in->scale.x);
+	pose_out->scale.y = a3recip(pose_in->scale.y);
+	pose_out->scale.z = a3recip(pose_in->scale.z);
+	pose_out->translation.x = -pose_in->translation.x;
+	pose_out->translation.y = -pose_in->translation.y;
+	pose_out->translation.z = -pose_in->translation.z;
+}
+
+// concatenate kernel
+inline void a3spatialPoseInternalOpConcat(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_lhs, const a3_SpatialPose *pose_rhs)
+{
+	a3spatialPoseInternalConcatOrient(&pose_out->orientation, &pose_lhs->orientation, &pose_rhs->orientation);
+	a3spatialPoseInternalConcatScale(&pose_out->scale, &pose_lhs->scale, &pose_rhs->scale);
+	a3spatialPoseInternalConcatTranslate(&pose_out->translation, &pose_lhs->translation, &pose_rhs->translation);
+}
+
+// lerp kernel
+inline void a3spatialPoseInternalOpLerp(a3_SpatialPose *pose_out, const a3_SpatialPose *pose0, const a3_SpatialPose *pose1, const a3real u)
+{
+	a3spatialPoseInternalLerpOrient(&pose_out->orientation, &pose0->orientation, &pose1->orientation, u);
+	a3spatialPoseInternalLerpVec3(&pose_out->scale, &pose0->scale, &pose1->scale, u);
+	a3spatialPoseInternalLerpVec3(&pose_out->translation, &pose0->translation, &pose1->translation, u);
+}
+
+// slerp kernel
+inline void a3spatialPoseInternalOpSlerp(a3_SpatialPose *pose_out, const a3_SpatialPose *pose0, const a3_SpatialPose *pose1, const a3real u)
+{
+	a3vec4 q1 = pose1->orientation;
+	if ((pose0->orientation.x * q1.x + pose0->orientation.y * q1.y + pose0->orientation.z * q1.z + pose0->orientation.w * q1.w) < a3real_zero)
+	{
+		q1.x = -q1.x;
+		q1.y = -q1.y;
+		q1.z = -q1.z;
+		q1.w = -q1.w;
+	}
+	a3quatSlerpUnit(pose_out->orientation.v, pose0->orientation.v, q1.v, u);
+	a3spatialPoseInternalLerpVec3(&pose_out->scale, &pose0->scale, &pose1->scale, u);
+	a3spatialPoseInternalLerpVec3(&pose_out->translation, &pose0->translation, &pose1->translation, u);
+}
+
+// scale kernel: from identity toward the input
+inline void a3spatialPoseInternalOpScale(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_in, const a3real u)
+{
+	const a3real u0 = a3real_one - u;
+	const a3vec4 q = pose_in->orientation;
+	const a3real u1 = q.w < a3real_zero ? -u : u;
+	const a3real x = q.x * u1, y = q.y * u1, z = q.z * u1, w = q.w * u1 + u0;
+	const a3real lenInv = a3sqrtInverse(x * x + y * y + z * z + w * w);
+	pose_out->orientation.x = x * lenInv;
+	pose_out->orientation.y = y * lenInv;
+	pose_out->orientation.z = z * lenInv;
+	pose_out->orientation.w = w * lenInv;
+	pose_out->scale.x = pose_in->scale.x * u + u0;
+	pose_out->scale.y = pose_in->scale.y * u + u0;
+	pose_out->scale.z = pose_in->scale.z * u + u0;
+	pose_out->translation.x = pose_in->translation.x * u;
+	pose_out->translation.y = pose_in->translation.y * u;
+	pose_out->translation.z = pose_in->translation.z * u;
+}
+
+// bilerp kernel
+inline void a3spatialPoseInternalOpBilerp(a3_SpatialPose *pose_out, const a3_SpatialPose *pose00, const a3_SpatialPose *pose01, const a3_SpatialPose *pose10, const a3_SpatialPose *pose11, const a3real u0, const a3real u1)
+{
+	const a3real v0 = a3real_one - u0, v1 = a3real_one - u1;
+	a3spatialPoseInternalSum(pose_out, pose00, pose01, pose10, pose11, v0 * v1, u0 * v1, v0 * u1, u0 * u1);
+}
+
+// triangular kernel
+inline void a3spatialPoseInternalOpTriangular(a3_SpatialPose *pose_out, const a3_SpatialPose *pose0, const a3_SpatialPose *pose1, const a3_SpatialPose *pose2, const a3real u1, const a3real u2)
+{
+	a3spatialPoseInternalSum(pose_out, pose0, pose1, pose2, pose0, a3real_one - u1 - u2, u1, u2, a3real_zero);
+}
+
+// cubic kernel: Catmull-Rom basis weights
+inline void a3spatialPoseInternalOpCubic(a3_SpatialPose *pose_out, const a3_SpatialPose *posePrev, const a3_SpatialPose *pose0, const a3_SpatialPose *pose1, const a3_SpatialPose *poseNext, const a3real u)
+{
+	const a3real u2 = u * u, u3 = u2 * u;
+	const a3real wPrev = (-u + a3real_two * u2 - u3) * a3real_half;
+	const a3real w0 = (a3real_two - (a3real)5 * u2 + (a3real)3 * u3) * a3real_half;
+	const a3real w1 = (u + (a3real)4 * u2 - (a3real)3 * u3) * a3real_half;
+	const a3real wNext = (u3 - u2) * a3real_half;
+
+	// orientation sum is anchored on pose0 so that flips are judged 
+	//	against the segment start
+	a3spatialPoseInternalSumOrient(&pose_out->orientation, &pose0->orientation, &posePrev->orientation, &pose1->orientation, &poseNext->orientation, w0, wPrev, w1, wNext);
+	a3spatialPoseInternalSumVec3(&pose_out->scale, &posePrev->scale, &pose0->scale, &pose1->scale, &poseNext->scale, wPrev, w0, w1, wNext);
+	a3spatialPoseInternalSumVec3(&pose_out->translation, &posePrev->translation, &pose0->translation, &pose1->translation, &poseNext->translation, wPrev, w0, w1, wNext);
+}
+
+// additive kernel: delta of the additive pose from its reference, scaled 
+//	from identity by u, then applied on top of the base
+inline void a3spatialPoseInternalOpAdditive(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_base, const a3_SpatialPose *pose_additive, const a3_SpatialPose *pose_reference, const a3real u)
+{
+	a3_SpatialPose delta;
+	a3spatialPoseInternalOpNegate(&delta, pose_reference);
+	a3spatialPoseInternalOpConcat(&delta, &delta, pose_additive);
+	a3spatialPoseInternalOpScale(&delta, &delta, u);
+	a3spatialPoseInternalOpConcat(pose_out, pose_base, &delta);
+}
+
+
+//-----------------------------------------------------------------------------
+
+// identity pose
+inline a3i32 a3spatialPoseOpIdentity(a3_SpatialPose *pose_out)
+{
+	if (pose_out)
+	{
+		a3spatialPoseInternalOpIdentity(pose_out);
+		return 1;
+	}
+	return -1;
+}
+
+// construct pose
+inline a3i32 a3spatialPoseOpInit(a3_SpatialPose *pose_out, const a3vec4 *orientation, const a3vec3 *scale, const a3vec3 *translation)
+{
+	if (pose_out && orientation && scale && translation)
+	{
+		pose_out->orientation = *orientation;
+		pose_out->scale = *scale;
+		pose_out->translation = *translation;
+		return 1;
+	}
+	return -1;
+}
+
+// copy pose
+inline a3i32 a3spatialPoseOpCopy(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_in)
+{
+	if (pose_out && pose_in)
+	{
+		*pose_out = *pose_in;
+		return 1;
+	}
+	return -1;
+}
+
+// negate pose
+inline a3i32 a3spatialPoseOpNegate(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_in)
+{
+	if (pose_out && pose_in)
+	{
+		a3spatialPoseInternalOpNegate(pose_out, pose_in);
+		return 1;
+	}
+	return -1;
+}
+
+// concatenate poses
+inline a3i32 a3spatialPoseOpConcat(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_lhs, const a3_SpatialPose *pose_rhs)
+{
+	if (pose_out && pose_lhs && pose_rhs)
+	{
+		a3spatialPoseInternalOpConcat(pose_out, pose_lhs, pose_rhs);
+		return 1;
+	}
+	return -1;
+}
+
+// lerp poses
+inline a3i32 a3spatialPoseOpLerp(a3_SpatialPose *pose_out, const a3_SpatialPose *pose0, const a3_SpatialPose *pose1, const a3real u)
+{
+	if (pose_out && pose0 && pose1)
+	{
+		a3spatialPoseInternalOpLerp(pose_out, pose0, pose1, u);
+		return 1;
+	}
+	return -1;
+}
+
+// slerp poses
+inline a3i32 a3spatialPoseOpSlerp(a3_SpatialPose *pose_out, const a3_SpatialPose *pose0, const a3_SpatialPose *pose1, const a3real u)
+{
+	if (pose_out && pose0 && pose1)
+	{
+		a3spatialPoseInternalOpSlerp(pose_out, pose0, pose1, u);
+		return 1;
+	}
+	return -1;
+}
+
+// scale pose
+inline a3i32 a3spatialPoseOpScale(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_in, const a3real u)
+{
+	if (pose_out && pose_in)
+	{
+		a3spatialPoseInternalOpScale(pose_out, pose_in, u);
+		return 1;
+	}
+	return -1;
+}
+
+// bilerp poses
+inline a3i32 a3spatialPoseOpBilerp(a3_SpatialPose *pose_out, const a3_SpatialPose *pose00, const a3_SpatialPose *pose01, const a3_SpatialPose *pose10, const a3_SpatialPose *pose11, const a3real u0, const a3real u1)
+{
+	if (pose_out && pose00 && pose01 && pose10 && pose11)
+	{
+		a3spatialPoseInternalOpBilerp(pose_out, pose00, pose01, pose10, pose11, u0, u1);
+		return 1;
+	}
+	return -1;
+}
+
+// triangular blend poses
+inline a3i32 a3spatialPoseOpTriangular(a3_SpatialPose *pose_out, const a3_SpatialPose *pose0, const a3_SpatialPose *pose1, const a3_SpatialPose *pose2, const a3real u1, const a3real u2)
+{
+	if (pose_out && pose0 && pose1 && pose2)
+	{
+		a3spatialPoseInternalOpTriangular(pose_out, pose0, pose1, pose2, u1, u2);
+		return 1;
+	}
+	return -1;
+}
+
+// cubic blend poses
+inline a3i32 a3spatialPoseOpCubic(a3_SpatialPose *pose_out, const a3_SpatialPose *posePrev, const a3_SpatialPose *pose0, const a3_SpatialPose *pose1, const a3_SpatialPose *poseNext, const a3real u)
+{
+	if (pose_out && posePrev && pose0 && pose1 && poseNext)
+	{
+		a3spatialPoseInternalOpCubic(pose_out, posePrev, pose0, pose1, poseNext, u);
+		return 1;
+	}
+	return -1;
+}
+
+// additive layer
+inline a3i32 a3spatialPoseOpAdditive(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_base, const a3_SpatialPose *pose_additive, const a3_SpatialPose *pose_reference, const a3real u)
+{
+	if (pose_out && pose_base && pose_additive && pose_reference)
+	{
+		a3spatialPoseInternalOpAdditive(pose_out, pose_base, pose_additive, pose_reference, u);
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// identity hierarchy pose
+inline a3i32 a3hierarchyPoseOpIdentity(const a3_HierarchyPose *pose_out, const a3ui32 nodeCount)
+{
+	if (pose_out && pose_out->spatialPose)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseInternalOpIdentity(out + i);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// construct hierarchy pose
+inline a3i32 a3hierarchyPoseOpInit(const a3_HierarchyPose *pose_out, const a3ui32 nodeCount, const a3vec4 *orientation, const a3vec3 *scale, const a3vec3 *translation)
+{
+	if (pose_out && pose_out->spatialPose && orientation && scale && translation)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+		{
+			out[i].orientation = *orientation;
+			out[i].scale = *scale;
+			out[i].translation = *translation;
+		}
+		return nodeCount;
+	}
+	return -1;
+}
+
+// copy hierarchy pose
+inline a3i32 a3hierarchyPoseOpCopy(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount)
+{
+	if (pose_out && pose_out->spatialPose && pose_in && pose_in->spatialPose)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		const a3_SpatialPose *in = pose_in->spatialPose;
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			out[i] = in[i];
+		return nodeCount;
+	}
+	return -1;
+}
+
+// negate hierarchy pose
+inline a3i32 a3hierarchyPoseOpNegate(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount)
+{
+	if (pose_out && pose_out->spatialPose && pose_in && pose_in->spatialPose)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		const a3_SpatialPose *in = pose_in->spatialPose;
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseInternalOpNegate(out + i, in + i);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// concatenate hierarchy poses
+inline a3i32 a3hierarchyPoseOpConcat(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_lhs, const a3_HierarchyPose *pose_rhs, const a3ui32 nodeCount)
+{
+	if (pose_out && pose_out->spatialPose && pose_lhs && pose_lhs->spatialPose && pose_rhs && pose_rhs->spatialPose)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		const a3_SpatialPose *lhs = pose_lhs->spatialPose, *rhs = pose_rhs->spatialPose;
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseInternalOpConcat(out + i, lhs + i, rhs + i);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// lerp hierarchy poses
+inline a3i32 a3hierarchyPoseOpLerp(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose0, const a3_HierarchyPose *pose1, const a3ui32 nodeCount, const a3real u)
+{
+	if (pose_out && pose_out->spatialPose && pose0 && pose0->spatialPose && pose1 && pose1->spatialPose)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		const a3_SpatialPose *p0 = pose0->spatialPose, *p1 = pose1->spatialPose;
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseInternalOpLerp(out + i, p0 + i, p1 + i, u);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// slerp hierarchy poses
+inline a3i32 a3hierarchyPoseOpSlerp(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose0, const a3_HierarchyPose *pose1, const a3ui32 nodeCount, const a3real u)
+{
+	if (pose_out && pose_out->spatialPose && pose0 && pose0->spatialPose && pose1 && pose1->spatialPose)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		const a3_SpatialPose *p0 = pose0->spatialPose, *p1 = pose1->spatialPose;
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseInternalOpSlerp(out + i, p0 + i, p1 + i, u);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// scale hierarchy pose
+inline a3i32 a3hierarchyPoseOpScale(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount, const a3real u)
+{
+	if (pose_out && pose_out->spatialPose && pose_in && pose_in->spatialPose)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		const a3_SpatialPose *in = pose_in->spatialPose;
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseInternalOpScale(out + i, in + i, u);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// bilerp hierarchy poses
+inline a3i32 a3hierarchyPoseOpBilerp(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose00, const a3_HierarchyPose *pose01, const a3_HierarchyPose *pose10, const a3_HierarchyPose *pose11, const a3ui32 nodeCount, const a3real u0, const a3real u1)
+{
+	if (pose_out && pose_out->spatialPose && pose00 && pose00->spatialPose && pose01 && pose01->spatialPose && 
+		pose10 && pose10->spatialPose && pose11 && pose11->spatialPose)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		const a3_SpatialPose *p00 = pose00->spatialPose, *p01 = pose01->spatialPose, *p10 = pose10->spatialPose, *p11 = pose11->spatialPose;
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseInternalOpBilerp(out + i, p00 + i, p01 + i, p10 + i, p11 + i, u0, u1);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// triangular blend hierarchy poses
+inline a3i32 a3hierarchyPoseOpTriangular(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose0, const a3_HierarchyPose *pose1, const a3_HierarchyPose *pose2, const a3ui32 nodeCount, const a3real u1, const a3real u2)
+{
+	if (pose_out && pose_out->spatialPose && pose0 && pose0->spatialPose && pose1 && pose1->spatialPose && pose2 && pose2->spatialPose)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		const a3_SpatialPose *p0 = pose0->spatialPose, *p1 = pose1->spatialPose, *p2 = pose2->spatialPose;
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseInternalOpTriangular(out + i, p0 + i, p1 + i, p2 + i, u1, u2);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// cubic blend hierarchy poses
+inline a3i32 a3hierarchyPoseOpCubic(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *posePrev, const a3_HierarchyPose *pose0, const a3_HierarchyPose *pose1, const a3_HierarchyPose *poseNext, const a3ui32 nodeCount, const a3real u)
+{
+	if (pose_out && pose_out->spatialPose && posePrev && posePrev->spatialPose && pose0 && pose0->spatialPose && 
+		pose1 && pose1->spatialPose && poseNext && poseNext->spatialPose)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		const a3_SpatialPose *pp = posePrev->spatialPose, *p0 = pose0->spatialPose, *p1 = pose1->spatialPose, *pn = poseNext->spatialPose;
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			a3spatialPoseInternalOpCubic(out + i, pp + i, p0 + i, p1 + i, pn + i, u);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// override layer, optionally masked
+inline a3i32 a3hierarchyPoseOpOverride(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_base, const a3_HierarchyPose *pose_layer, const a3ui32 nodeCount, const a3real u, const a3real *mask_opt)
+{
+	if (pose_out && pose_out->spatialPose && pose_base && pose_base->spatialPose && pose_layer && pose_layer->spatialPose)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		const a3_SpatialPose *pb = pose_base->spatialPose, *pl = pose_layer->spatialPose;
+		a3ui32 i;
+		if (mask_opt)
+			for (i = 0; i < nodeCount; ++i)
+				a3spatialPoseInternalOpLerp(out + i, pb + i, pl + i, u * mask_opt[i]);
+		else
+			for (i = 0; i < nodeCount; ++i)
+				a3spatialPoseInternalOpLerp(out + i, pb + i, pl + i, u);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// additive layer, optionally masked
+inline a3i32 a3hierarchyPoseOpAdditive(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_base, const a3_HierarchyPose *pose_additive, const a3_HierarchyPose *pose_reference, const a3ui32 nodeCount, const a3real u, const a3real *mask_opt)
+{
+	if (pose_out && pose_out->spatialPose && pose_base && pose_base->spatialPose && 
+		pose_additive && pose_additive->spatialPose && pose_reference && pose_reference->spatialPose)
+	{
+		a3_SpatialPose *out = pose_out->spatialPose;
+		const a3_SpatialPose *pb = pose_base->spatialPose, *pa = pose_additive->spatialPose, *pr = pose_reference->spatialPose;
+		a3ui32 i;
+		if (mask_opt)
+			for (i = 0; i < nodeCount; ++i)
+				a3spatialPoseInternalOpAdditive(out + i, pb + i, pa + i, pr + i, u * mask_opt[i]);
+		else
+			for (i = 0; i < nodeCount; ++i)
+				a3spatialPoseInternalOpAdditive(out + i, pb + i, pa + i, pr + i, u);
+		return nodeCount;
+	}
+	return -1;
+}
 
 
 //-----------------------------------------------------------------------------
@@ -30,6 +30,768 @@
 
 //-----------------------------------------------------------------------------
 
+// reset single node pose
+inline a3i32 a3spatialPoseReset(a3_SpatialPose *spatialPose)
+{
+	if (spatialPose)
+	{
+		spatialPose->orientation.x = spatialPose->orientation.y = spatialPose->orientation.z = a3real_zero;
+		spatialPose->orientation.w = a3real_one;
+		spatialPose->scale.x = spatialPose->scale.y = spatialPose->scale.z = a3real_one;
+		spatialPose->translation.x = spatialPose->translation.y = spatialPose->translation.z = a3real_zero;
+		return 1;
+	}
+	return -1;
+}
+
+// set orientation of single node pose from Euler angles
+inline a3i32 a3spatialPoseSetRotation(a3_SpatialPose *spatialPose, const a3real degrees_x, const a3real degrees_y, const a3real degrees_z)
+{
+	if (spatialPose)
+	{
+		a3quatSetEulerXYZ(spatialPose->orientation.v, degrees_x, degrees_y, degrees_z);
+		return 1;
+	}
+	return -1;
+}
+
+// set scale of single node pose
+inline a3i32 a3spatialPoseSetScale(a3_SpatialPose *spatialPose, const a3real scale_x, const a3real scale_y, const a3real scale_z)
+{
+	if (spatialPose)
+	{
+		spatialPose->scale.x = scale_x;
+		spatialPose->scale.y = scale_y;
+		spatialPose->scale.z = scale_z;
+		return 1;
+	}
+	return -1;
+}
+
+// set translation of single node pose
+inline a3i32 a3spatialPoseSetTranslation(a3_SpatialPose *spatialPose, const a3real translate_x, const a3real translate_y, const a3real translate_z)
+{
+	if (spatialPose)
+	{
+		spatialPose->translation.x = translate_x;
+		spatialPose->translation.y = translate_y;
+		spatialPose->translation.z = translate_z;
+		return 1;
+	}
+	return -1;
+}
+
+// copy single node pose
+inline a3i32 a3spatialPoseCopy(a3_SpatialPose *spatialPose_out, const a3_SpatialPose *spatialPose_in)
+{
+	if (spatialPose_out && spatialPose_in)
+	{
+		*spatialPose_out = *spatialPose_in;
+		return 1;
+	}
+	return -1;
+}
+
+// channel groups present in a channel mask, used to select a specialized 
+//	path for each combination
+enum a3_SpatialPoseInternalChannelGroup
+{
+	a3poseInternalGroup_orient = 0x1,
+	a3poseInternalGroup_scale = 0x2,
+	a3poseInternalGroup_translate = 0x4,
+};
+
+inline a3ui32 a3spatialPoseInternalGetChannelGroup(const a3_SpatialPoseChannel channel)
+{
+	return ((channel & a3poseChannel_orient_xyz) ? a3poseInternalGroup_orient : 0)
+		| ((channel & a3poseChannel_scale_xyz) ? a3poseInternalGroup_scale : 0)
+		| ((channel & a3poseChannel_translate_xyz) ? a3poseInternalGroup_translate : 0);
+}
+
+// write rotation basis from unit quaternion
+inline void a3spatialPoseInternalConvertOrient(a3mat4 *m, const a3vec4 *q)
+{
+	const a3real x2 = q->x + q->x, y2 = q->y + q->y, z2 = q->z + q->z;
+	const a3real xx = q->x * x2, yy = q->y * y2, zz = q->z * z2;
+	const a3real xy = q->x * y2, yz = q->y * z2, zx = q->z * x2;
+	const a3real wx = q->w * x2, wy = q->w * y2, wz = q->w * z2;
+	m->m00 = a3real_one - yy - zz;
+	m->m01 = xy + wz;
+	m->m02 = zx - wy;
+	m->m10 = xy - wz;
+	m->m11 = a3real_one - zz - xx;
+	m->m12 = yz + wx;
+	m->m20 = zx + wy;
+	m->m21 = yz - wx;
+	m->m22 = a3real_one - xx - yy;
+}
+
+// scale basis columns
+inline void a3spatialPoseInternalConvertScale(a3mat4 *m, const a3vec3 *s)
+{
+	m->m00 *= s->x;
+	m->m01 *= s->x;
+	m->m02 *= s->x;
+	m->m10 *= s->y;
+	m->m11 *= s->y;
+	m->m12 *= s->y;
+	m->m20 *= s->z;
+	m->m21 *= s->z;
+	m->m22 *= s->z;
+}
+
+// write translation and affine bottom row
+inline void a3spatialPoseInternalConvertTranslate(a3mat4 *m, const a3vec3 *t)
+{
+	m->m30 = t->x;
+	m->m31 = t->y;
+	m->m32 = t->z;
+	m->m03 = m->m13 = m->m23 = a3real_zero;
+	m->m33 = a3real_one;
+}
+
+// convert single node pose to matrix
+inline a3i32 a3spatialPoseConvert(a3mat4 *mat_out, const a3_SpatialPose *spatialPose_in)
+{
+	if (mat_out && spatialPose_in)
+	{
+		// M = T * R * S; channels not in use are still converted from the 
+		//	pose, which holds their base values since blending leaves them 
+		//	untouched (e.g. the bone offset of a rotation-only joint)
+		a3spatialPoseInternalConvertOrient(mat_out, &spatialPose_in->orientation);
+		a3spatialPoseInternalConvertScale(mat_out, &spatialPose_in->scale);
+		a3spatialPoseInternalConvertTranslate(mat_out, &spatialPose_in->translation);
+		return 1;
+	}
+	return -1;
+}
+
+// restore single node pose from matrix
+inline a3i32 a3spatialPoseRestore(a3_SpatialPose *spatialPose_out, const a3mat4 *mat_in)
+{
+	if (spatialPose_out && mat_in)
+	{
+		const a3real sx = a3sqrt(mat_in->m00 * mat_in->m00 + mat_in->m01 * mat_in->m01 + mat_in->m02 * mat_in->m02);
+		const a3real sy = a3sqrt(mat_in->m10 * mat_in->m10 + mat_in->m11 * mat_in->m11 + mat_in->m12 * mat_in->m12);
+		const a3real sz = a3sqrt(mat_in->m20 * mat_in->m20 + mat_in->m21 * mat_in->m21 + mat_in->m22 * mat_in->m22);
+		const a3real isx = sx > a3real_zero ? a3real_one / sx : a3real_zero;
+		const a3real isy = sy > a3real_zero ? a3real_one / sy : a3real_zero;
+		const a3real isz = sz > a3real_zero ? a3real_one / sz : a3real_zero;
+		const a3real r00 = mat_in->m00 * isx, r11 = mat_in->m11 * isy, r22 = mat_in->m22 * isz;
+		const a3real r01 = mat_in->m01 * isx, r02 = mat_in->m02 * isx, r10 = mat_in->m10 * isy;
+		const a3real r12 = mat_in->m12 * isy, r20 = mat_in->m20 * isz, r21 = mat_in->m21 * isz;
+		const a3real tw = a3real_one + r00 + r11 + r22, tx = a3real_one + r00 - r11 - r22;
+		const a3real ty = a3real_one - r00 + r11 - r22, tz = a3real_one - r00 - r11 + r22;
+		a3real x, y, z, w, root, sc, len;
+
+		// quaternion from rotation: the largest component comes from the 
+		//	diagonal, the others from off-diagonal sums and differences 
+		//	divided by it, so no sign is lost at 180 degree turns
+		if (tw >= tx && tw >= ty && tw >= tz)
+		{
+			root = a3sqrt(tw);
+			sc = a3real_half / root;
+			w = root * a3real_half;
+			x = (r12 - r21) * sc;
+			y = (r20 - r02) * sc;
+			z = (r01 - r10) * sc;
+		}
+		else if (tx >= ty && tx >= tz)
+		{
+			root = a3sqrt(tx);
+			sc = a3real_half / root;
+			w = (r12 - r21) * sc;
+			x = root * a3real_half;
+			y = (r01 + r10) * sc;
+			z = (r20 + r02) * sc;
+		}
+		else if (ty >= tz)
+		{
+			root = a3sqrt(ty);
+			sc = a3real_half / root;
+			w = (r20 - r02) * sc;
+			x = (r01 + r10) * sc;
+			y = root * a3real_half;
+			z = (r12 + r21) * sc;
+		}
+		else
+		{
+			root = a3sqrt(tz);
+			sc = a3real_half / root;
+			w = (r01 - r10) * sc;
+			x = (r20 + r02) * sc;
+			y = (r12 + r21) * sc;
+			z = root * a3real_half;
+		}
+
+		// keep w non-negative
+		if (w < a3real_zero)
+		{
+			x = -x;
+			y = -y;
+			z = -z;
+			w = -w;
+		}
+		len = a3real_one / a3sqrt(x * x + y * y + z * z + w * w);
+
+		spatialPose_out->orientation.x = x * len;
+		spatialPose_out->orientation.y = y * len;
+		spatialPose_out->orientation.z = z * len;
+		spatialPose_out->orientation.w = w * len;
+		spatialPose_out->scale.x = sx;
+		spatialPose_out->scale.y = sy;
+		spatialPose_out->scale.z = sz;
+		spatialPose_out->translation.x = mat_in->m30;
+		spatialPose_out->translation.y = mat_in->m31;
+		spatialPose_out->translation.z = mat_in->m32;
+		return 1;
+	}
+	return -1;
+}
+
+// concatenate orientations: quaternion product
+inline void a3spatialPoseInternalConcatOrient(a3vec4 *q_out, const a3vec4 *qL_in, const a3vec4 *qR_in)
+{
+	const a3vec4 qL = *qL_in, qR = *qR_in;
+	q_out->x = qL.w * qR.x + qL.x * qR.w + qL.y * qR.z - qL.z * qR.y;
+	q_out->y = qL.w * qR.y - qL.x * qR.z + qL.y * qR.w + qL.z * qR.x;
+	q_out->z = qL.w * qR.z + qL.x * qR.y - qL.y * qR.x + qL.z * qR.w;
+	q_out->w = qL.w * qR.w - qL.x * qR.x - qL.y * qR.y - qL.z * qR.z;
+}
+
+// concatenate scales: component-wise product
+inline void a3spatialPoseInternalConcatScale(a3vec3 *s_out, const a3vec3 *sL, const a3vec3 *sR)
+{
+	s_out->x = sL->x * sR->x;
+	s_out->y = sL->y * sR->y;
+	s_out->z = sL->z * sR->z;
+}
+
+// concatenate translations: sum
+inline void a3spatialPoseInternalConcatTranslate(a3vec3 *t_out, const a3vec3 *tL, const a3vec3 *tR)
+{
+	t_out->x = tL->x + tR->x;
+	t_out->y = tL->y + tR->y;
+	t_out->z = tL->z + tR->z;
+}
+
+// concatenate two single node poses
+inline a3i32 a3spatialPoseConcat(a3_SpatialPose *spatialPose_out, const a3_SpatialPose *spatialPose_lhs, const a3_SpatialPose *spatialPose_rhs, const a3_SpatialPoseChannel channel)
+{
+	if (spatialPose_out && spatialPose_lhs && spatialPose_rhs)
+	{
+		switch (a3spatialPoseInternalGetChannelGroup(channel))
+		{
+		case a3poseInternalGroup_orient:
+			a3spatialPoseInternalConcatOrient(&spatialPose_out->orientation, &spatialPose_lhs->orientation, &spatialPose_rhs->orientation);
+			break;
+		case a3poseInternalGroup_orient | a3poseInternalGroup_translate:
+			a3spatialPoseInternalConcatOrient(&spatialPose_out->orientation, &spatialPose_lhs->orientation, &spatialPose_rhs->orientation);
+			a3spatialPoseInternalConcatTranslate(&spatialPose_out->translation, &spatialPose_lhs->translation, &spatialPose_rhs->translation);
+			break;
+		case a3poseInternalGroup_orient | a3poseInternalGroup_scale:
+			a3spatialPoseInternalConcatOrient(&spatialPose_out->orientation, &spatialPose_lhs->orientation, &spatialPose_rhs->orientation);
+			a3spatialPoseInternalConcatScale(&spatialPose_out->scale, &spatialPose_lhs->scale, &spatialPose_rhs->scale);
+			break;
+		case a3poseInternalGroup_orient | a3poseInternalGroup_scale | a3poseInternalGroup_translate:
+			a3spatialPoseInternalConcatOrient(&spatialPose_out->orientation, &spatialPose_lhs->orientation, &spatialPose_rhs->orientation);
+			a3spatialPoseInternalConcatScale(&spatialPose_out->scale, &spatialPose_lhs->scale, &spatialPose_rhs->scale);
+			a3spatialPoseInternalConcatTranslate(&spatialPose_out->translation, &spatialPose_lhs->translation, &spatialPose_rhs->translation);
+			break;
+		case a3poseInternalGroup_translate:
+			a3spatialPoseInternalConcatTranslate(&spatialPose_out->translation, &spatialPose_lhs->translation, &spatialPose_rhs->translation);
+			break;
+		case a3poseInternalGroup_scale:
+			a3spatialPoseInternalConcatScale(&spatialPose_out->scale, &spatialPose_lhs->scale, &spatialPose_rhs->scale);
+			break;
+		case a3poseInternalGroup_scale | a3poseInternalGroup_translate:
+			a3spatialPoseInternalConcatScale(&spatialPose_out->scale, &spatialPose_lhs->scale, &spatialPose_rhs->scale);
+			a3spatialPoseInternalConcatTranslate(&spatialPose_out->translation, &spatialPose_lhs->translation, &spatialPose_rhs->translation);
+			break;
+		default:
+			return 0;
+		}
+		return 1;
+	}
+	return -1;
+}
+
+// inverse square root matching the SSE lane lerp: correctly rounded 
+//	square root and divide, unlike the precompiled a3sqrtInverse
+inline a3real a3spatialPoseInternalSqrtInverse(const a3real x)
+{
+#ifdef A3_SPATIALPOSE_SSE
+	return _mm_cvtss_f32(_mm_div_ss(_mm_set_ss(a3real_one), _mm_sqrt_ss(_mm_set_ss(x))));
+#else	// !A3_SPATIALPOSE_SSE
+	return a3sqrtInverse(x);
+#endif	// A3_SPATIALPOSE_SSE
+}
+
+// interpolate orientations: normalized lerp along the shorter arc
+inline void a3spatialPoseInternalLerpOrient(a3vec4 *q_out, const a3vec4 *q0, const a3vec4 *q1, const a3real u)
+{
+	const a3real u1 = (q0->x * q1->x + q0->y * q1->y + q0->z * q1->z + q0->w * q1->w) < a3real_zero ? -u : u;
+	const a3real u0 = a3real_one - u;
+	const a3real x = q0->x * u0 + q1->x * u1, y = q0->y * u0 + q1->y * u1, z = q0->z * u0 + q1->z * u1, w = q0->w * u0 + q1->w * u1;
+	const a3real lenInv = a3spatialPoseInternalSqrtInverse(x * x + y * y + z * z + w * w);
+	q_out->x = x * lenInv;
+	q_out->y = y * lenInv;
+	q_out->z = z * lenInv;
+	q_out->w = w * lenInv;
+}
+
+// interpolate vectors: lerp
+inline void a3spatialPoseInternalLerpVec3(a3vec3 *v_out, const a3vec3 *v0, const a3vec3 *v1, const a3real u)
+{
+	v_out->x = v0->x + (v1->x - v0->x) * u;
+	v_out->y = v0->y + (v1->y - v0->y) * u;
+	v_out->z = v0->z + (v1->z - v0->z) * u;
+}
+
+// interpolate between two single node poses
+inline a3i32 a3spatialPoseLerp(a3_SpatialPose *spatialPose_out, const a3_SpatialPose *spatialPose0, const a3_SpatialPose *spatialPose1, const a3real u, const a3_SpatialPoseChannel channel)
+{
+	if (spatialPose_out && spatialPose0 && spatialPose1)
+	{
+		switch (a3spatialPoseInternalGetChannelGroup(channel))
+		{
+		case a3poseInternalGroup_orient:
+			a3spatialPoseInternalLerpOrient(&spatialPose_out->orientation, &spatialPose0->orientation, &spatialPose1->orientation, u);
+			break;
+		case a3poseInternalGroup_orient | a3poseInternalGroup_translate:
+			a3spatialPoseInternalLerpOrient(&spatialPose_out->orientation, &spatialPose0->orientation, &spatialPose1->orientation, u);
+			a3spatialPoseInternalLerpVec3(&spatialPose_out->translation, &spatialPose0->translation, &spatialPose1->translation, u);
+			break;
+		case a3poseInternalGroup_orient | a3poseInternalGroup_scale:
+			a3spatialPoseInternalLerpOrient(&spatialPose_out->orientation, &spatialPose0->orientation, &spatialPose1->orientation, u);
+			a3spatialPoseInternalLerpVec3(&spatialPose_out->scale, &spatialPose0->scale, &spatialPose1->scale, u);
+			break;
+		case a3poseInternalGroup_orient | a3poseInternalGroup_scale | a3poseInternalGroup_translate:
+			a3spatialPoseInternalLerpOrient(&spatialPose_out->orientation, &spatialPose0->orientation, &spatialPose1->orientation, u);
+			a3spatialPoseInternalLerpVec3(&spatialPose_out->scale, &spatialPose0->scale, &spatialPose1->scale, u);
+			a3spatialPoseInternalLerpVec3(&spatialPose_out->translation, &spatialPose0->translation, &spatialPose1->translation, u);
+			break;
+		case a3poseInternalGroup_translate:
+			a3spatialPoseInternalLerpVec3(&spatialPose_out->translation, &spatialPose0->translation, &spatialPose1->translation, u);
+			break;
+		case a3poseInternalGroup_scale:
+			a3spatialPoseInternalLerpVec3(&spatialPose_out->scale, &spatialPose0->scale, &spatialPose1->scale, u);
+			break;
+		case a3poseInternalGroup_scale | a3poseInternalGroup_translate:
+			a3spatialPoseInternalLerpVec3(&spatialPose_out->scale, &spatialPose0->scale, &spatialPose1->scale, u);
+			a3spatialPoseInternalLerpVec3(&spatialPose_out->translation, &spatialPose0->translation, &spatialPose1->translation, u);
+			break;
+		default:
+			return 0;
+		}
+		return 1;
+	}
+	return -1;
+}
+
+
+// reset single node Euler pose
+inline a3i32 a3spatialPoseEulerReset(a3_SpatialPoseEuler *spatialPose, const a3_SpatialPoseEulerOrder order)
+{
+	if (spatialPose)
+	{
+		spatialPose->angles.x = spatialPose->angles.y = spatialPose->angles.z = a3real_zero;
+		spatialPose->scale.x = spatialPose->scale.y = spatialPose->scale.z = a3real_one;
+		spatialPose->translation.x = spatialPose->translation.y = spatialPose->translation.z = a3real_zero;
+		spatialPose->order = order;
+		return 1;
+	}
+	return -1;
+}
+
+// convert single node Euler pose to matrix
+inline a3i32 a3spatialPoseEulerConvert(a3mat4 *mat_out, const a3_SpatialPoseEuler *spatialPose_in)
+{
+	if (mat_out && spatialPose_in)
+	{
+		// table trig on the stored angles, animated or not (a static axis 
+		//	may hold a rest angle); zero angles skip the lookup
+		const a3real ax = spatialPose_in->angles.x, ay = spatialPose_in->angles.y, az = spatialPose_in->angles.z;
+		const a3real sx = ax != a3real_zero ? a3sind(ax) : a3real_zero;
+		const a3real cx = ax != a3real_zero ? a3cosd(ax) : a3real_one;
+		const a3real sy = ay != a3real_zero ? a3sind(ay) : a3real_zero;
+		const a3real cy = ay != a3real_zero ? a3cosd(ay) : a3real_one;
+		const a3real sz = az != a3real_zero ? a3sind(az) : a3real_zero;
+		const a3real cz = az != a3real_zero ? a3cosd(az) : a3real_one;
+
+		// rotation basis, expanded per order
+		switch (spatialPose_in->order)
+		{
+		case a3poseEulerOrder_xyz:
+			mat_out->m00 = cy * cz;
+			mat_out->m01 = cy * sz;
+			mat_out->m02 = -sy;
+			mat_out->m10 = cz * sx * sy - cx * sz;
+			mat_out->m11 = sx * sy * sz + cx * cz;
+			mat_out->m12 = cy * sx;
+			mat_out->m20 = cx * cz * sy + sx * sz;
+			mat_out->m21 = cx * sy * sz - cz * sx;
+			mat_out->m22 = cx * cy;
+			break;
+		case a3poseEulerOrder_yzx:
+			mat_out->m00 = cy * cz;
+			mat_out->m01 = cx * cy * sz + sx * sy;
+			mat_out->m02 = cy * sx * sz - cx * sy;
+			mat_out->m10 = -sz;
+			mat_out->m11 = cx * cz;
+			mat_out->m12 = cz * sx;
+			mat_out->m20 = cz * sy;
+			mat_out->m21 = cx * sy * sz - cy * sx;
+			mat_out->m22 = sx * sy * sz + cx * cy;
+			break;
+		case a3poseEulerOrder_zxy:
+			mat_out->m00 = sx * sy * sz + cy * cz;
+			mat_out->m01 = cx * sz;
+			mat_out->m02 = cy * sx * sz - cz * sy;
+			mat_out->m10 = cz * sx * sy - cy * sz;
+			mat_out->m11 = cx * cz;
+			mat_out->m12 = cy * cz * sx + sy * sz;
+			mat_out->m20 = cx * sy;
+			mat_out->m21 = -sx;
+			mat_out->m22 = cx * cy;
+			break;
+		case a3poseEulerOrder_yxz:
+			mat_out->m00 = -sx * sy * sz + cy * cz;
+			mat_out->m01 = cz * sx * sy + cy * sz;
+			mat_out->m02 = -cx * sy;
+			mat_out->m10 = -cx * sz;
+			mat_out->m11 = cx * cz;
+			mat_out->m12 = sx;
+			mat_out->m20 = cy * sx * sz + cz * sy;
+			mat_out->m21 = -cy * cz * sx + sy * sz;
+			mat_out->m22 = cx * cy;
+			break;
+		case a3poseEulerOrder_xzy:
+			mat_out->m00 = cy * cz;
+			mat_out->m01 = sz;
+			mat_out->m02 = -cz * sy;
+			mat_out->m10 = -cx * cy * sz + sx * sy;
+			mat_out->m11 = cx * cz;
+			mat_out->m12 = cx * sy * sz + cy * sx;
+			mat_out->m20 = cy * sx * sz + cx * sy;
+			mat_out->m21 = -cz * sx;
+			mat_out->m22 = -sx * sy * sz + cx * cy;
+			break;
+		case a3poseEulerOrder_zyx:
+			mat_out->m00 = cy * cz;
+			mat_out->m01 = cz * sx * sy + cx * sz;
+			mat_out->m02 = -cx * cz * sy + sx * sz;
+			mat_out->m10 = -cy * sz;
+			mat_out->m11 = -sx * sy * sz + cx * cz;
+			mat_out->m12 = cx * sy * sz + cz * sx;
+			mat_out->m20 = sy;
+			mat_out->m21 = -cy * sx;
+			mat_out->m22 = cx * cy;
+			break;
+		default:
+			return -1;
+		}
+
+		// scale and translation keep their stored values whether animated or not
+		a3spatialPoseInternalConvertScale(mat_out, &spatialPose_in->scale);
+		a3spatialPoseInternalConvertTranslate(mat_out, &spatialPose_in->translation);
+		return 1;
+	}
+	return -1;
+}
+
+// convert single node Euler pose to quaternion pose
+inline a3i32 a3spatialPoseEulerGetPose(a3_SpatialPose *spatialPose_out, const a3_SpatialPoseEuler *spatialPose_in)
+{
+	if (spatialPose_out && spatialPose_in)
+	{
+		// axis quaternions from half angles, concatenated last-applied first
+		static const a3ubyte axisOrder[6][3] = {
+			{ 0, 1, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 1, 0, 2 }, { 0, 2, 1 }, { 2, 1, 0 },
+		};
+		const a3real *angles = spatialPose_in->angles.v;
+		a3vec4 q[3] = { 0 };
+		a3ui32 i, axis;
+		if ((a3ui32)spatialPose_in->order > a3poseEulerOrder_zyx)
+			return -1;
+		for (i = 0; i < 3; ++i)
+		{
+			axis = axisOrder[spatialPose_in->order][i];
+			if (angles[axis] != a3real_zero)
+			{
+				q[i].v[axis] = a3sind(angles[axis] * a3real_half);
+				q[i].w = a3cosd(angles[axis] * a3real_half);
+			}
+			else
+				q[i].w = a3real_one;
+		}
+		a3spatialPoseInternalConcatOrient(&spatialPose_out->orientation, q + 1, q);
+		a3spatialPoseInternalConcatOrient(&spatialPose_out->orientation, q + 2, &spatialPose_out->orientation);
+		spatialPose_out->scale = spatialPose_in->scale;
+		spatialPose_out->translation = spatialPose_in->translation;
+		return 1;
+	}
+	return -1;
+}
+
+
+// reset single node dual quaternion pose
+inline a3i32 a3spatialPoseDQReset(a3_SpatialPoseDQ *spatialPose)
+{
+	if (spatialPose)
+	{
+		a3dualquatSetIdentity(spatialPose->transform.Q);
+		return 1;
+	}
+	return -1;
+}
+
+// set single node dual quaternion pose from pose
+inline a3i32 a3spatialPoseDQSetPose(a3_SpatialPoseDQ *spatialPose_out, const a3_SpatialPose *spatialPose_in)
+{
+	if (spatialPose_out && spatialPose_in)
+	{
+		spatialPose_out->transform.r.q[0] = spatialPose_in->orientation.x;
+		spatialPose_out->transform.r.q[1] = spatialPose_in->orientation.y;
+		spatialPose_out->transform.r.q[2] = spatialPose_in->orientation.z;
+		spatialPose_out->transform.r.q[3] = spatialPose_in->orientation.w;
+		a3dualquatCalculateDualPart(spatialPose_out->transform.d.q, spatialPose_out->transform.r.q, spatialPose_in->translation.v);
+		return 1;
+	}
+	return -1;
+}
+
+// get single node pose from dual quaternion pose
+inline a3i32 a3spatialPoseDQGetPose(a3_SpatialPose *spatialPose_out, const a3_SpatialPoseDQ *spatialPose_in)
+{
+	if (spatialPose_out && spatialPose_in)
+	{
+		spatialPose_out->orientation.x = spatialPose_in->transform.r.x;
+		spatialPose_out->orientation.y = spatialPose_in->transform.r.y;
+		spatialPose_out->orientation.z = spatialPose_in->transform.r.z;
+		spatialPose_out->orientation.w = spatialPose_in->transform.r.w;
+		spatialPose_out->scale.x = spatialPose_out->scale.y = spatialPose_out->scale.z = a3real_one;
+		a3dualquatCalculateTranslateIgnoreScale(spatialPose_out->translation.v, spatialPose_in->transform.r.q, spatialPose_in->transform.d.q);
+		return 1;
+	}
+	return -1;
+}
+
+// convert single node dual quaternion pose to matrix
+inline a3i32 a3spatialPoseDQConvert(a3mat4 *mat_out, const a3_SpatialPoseDQ *spatialPose_in)
+{
+	if (mat_out && spatialPose_in)
+	{
+		a3dualquatConvertToMat4IgnoreScale(mat_out->m, spatialPose_in->transform.Q);
+		return 1;
+	}
+	return -1;
+}
+
+// concatenate single node dual quaternion poses
+inline a3i32 a3spatialPoseDQConcat(a3_SpatialPoseDQ *spatialPose_out, const a3_SpatialPoseDQ *spatialPose_lhs, const a3_SpatialPoseDQ *spatialPose_rhs)
+{
+	if (spatialPose_out && spatialPose_lhs && spatialPose_rhs)
+	{
+		// product output cannot alias its inputs
+		a3dualquat result;
+		a3dualquatProduct(result.Q, spatialPose_lhs->transform.Q, spatialPose_rhs->transform.Q);
+		spatialPose_out->transform = result;
+		return 1;
+	}
+	return -1;
+}
+
+// interpolate single node dual quaternion poses with dual linear blending
+inline a3i32 a3spatialPoseDQLerp(a3_SpatialPoseDQ *spatialPose_out, const a3_SpatialPoseDQ *spatialPose0, const a3_SpatialPoseDQ *spatialPose1, const a3real u)
+{
+	if (spatialPose_out && spatialPose0 && spatialPose1)
+	{
+		const a3real *Q0 = spatialPose0->transform.QQ, *Q1 = spatialPose1->transform.QQ;
+		const a3real dot = Q0[0] * Q1[0] + Q0[1] * Q1[1] + Q0[2] * Q1[2] + Q0[3] * Q1[3];
+		const a3real u1 = dot < a3real_zero ? -u : u, u0 = a3real_one - u;
+		a3real *Q = spatialPose_out->transform.QQ;
+		a3ui32 i;
+		for (i = 0; i < 8; ++i)
+			Q[i] = Q0[i] * u0 + Q1[i] * u1;
+		a3dualquatNormalize(spatialPose_out->transform.Q);
+		return 1;
+	}
+	return -1;
+}
+
+// interpolate single node dual quaternion poses along the screw
+inline a3i32 a3spatialPoseDQSclerp(a3_SpatialPoseDQ *spatialPose_out, const a3_SpatialPoseDQ *spatialPose0, const a3_SpatialPoseDQ *spatialPose1, const a3real u)
+{
+	if (spatialPose_out && spatialPose0 && spatialPose1)
+	{
+		a3dualquat result;
+		a3dualquatSclerpUnit(result.Q, spatialPose0->transform.Q, spatialPose1->transform.Q, u);
+		spatialPose_out->transform = result;
+		return 1;
+	}
+	return -1;
+}
+
+// weighted dual linear blend of several dual quaternion poses
+inline a3i32 a3spatialPoseDQBlend(a3_SpatialPoseDQ *spatialPose_out, const a3_SpatialPoseDQ *spatialPoses, const a3ui32 *index, const a3real *weight, const a3ui32 count)
+{
+	if (spatialPose_out && spatialPoses && index && weight && count)
+	{
+		// keep every influence on the hemisphere of the first
+		const a3real *Q0 = spatialPoses[index[0]].transform.QQ, *Qi;
+		a3real result[8] = { 0 }, w;
+		a3ui32 i, j;
+		for (i = 0; i < count; ++i)
+		{
+			Qi = spatialPoses[index[i]].transform.QQ;
+			w = (Q0[0] * Qi[0] + Q0[1] * Qi[1] + Q0[2] * Qi[2] + Q0[3] * Qi[3]) < a3real_zero ? -weight[i] : weight[i];
+			for (j = 0; j < 8; ++j)
+				result[j] += Qi[j] * w;
+		}
+		for (j = 0; j < 8; ++j)
+			spatialPose_out->transform.QQ[j] = result[j];
+		a3dualquatNormalize(spatialPose_out->transform.Q);
+		return count;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// compact orientation quantization: smallest three components lie within 
+//	+/- 1/sqrt(2) and are mapped to 15 bits; the maximum is even so that 
+//	zero is exact
+#define a3spatialPoseInternalQuantMax		32766
+#define a3spatialPoseInternalQuantRange		(a3real)1.4142135623730950488016887242097
+
+// square root matching the SSE batch paths: both use the correctly 
+//	rounded IEEE instruction, unlike the precompiled a3sqrt
+inline a3real a3spatialPoseInternalSqrt(const a3real x)
+{
+#ifdef A3_SPATIALPOSE_SSE
+	return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(x)));
+#else	// !A3_SPATIALPOSE_SSE
+	return a3sqrt(x);
+#endif	// A3_SPATIALPOSE_SSE
+}
+
+// reinterpret float bits
+typedef union a3_SpatialPoseInternalBits
+{
+	a3f32 f;
+	a3ui32 u;
+} a3_SpatialPoseInternalBits;
+
+// float to half, round to nearest even
+inline a3ui16 a3spatialPoseInternalEncodeHalf(const a3real value)
+{
+	a3_SpatialPoseInternalBits bits, denorm;
+	a3ui32 sign;
+	bits.f = (a3f32)value;
+	sign = (bits.u >> 16) & 0x8000;
+	bits.u &= 0x7fffffff;
+
+	// overflow to infinity, keep nan
+	if (bits.u >= 0x47800000)
+		return (a3ui16)(sign | (bits.u > 0x7f800000 ? 0x7e00 : 0x7c00));
+
+	// denormal: let float addition do the rounding
+	if (bits.u < 0x38800000)
+	{
+		denorm.u = 0x3f000000;
+		bits.f += denorm.f;
+		return (a3ui16)(sign | (bits.u - denorm.u));
+	}
+
+	// normal: rebias exponent and round mantissa
+	bits.u += 0xc8000fff + ((bits.u >> 13) & 1);
+	return (a3ui16)(sign | (bits.u >> 13));
+}
+
+// half to float
+inline a3real a3spatialPoseInternalDecodeHalf(const a3ui16 value)
+{
+	// shift exponent and mantissa into place and rescale, which handles 
+	//	denormals; infinity and nan are patched afterwards
+	a3_SpatialPoseInternalBits bits, magic;
+	magic.u = 0x77800000;
+	bits.u = (a3ui32)(value & 0x7fff) << 13;
+	bits.f *= magic.f;
+	if ((value & 0x7fff) >= 0x7c00)
+		bits.u |= 0x7f800000;
+	bits.u |= (a3ui32)(value & 0x8000) << 16;
+	return bits.f;
+}
+
+// encode single node pose in compact form
+inline a3i32 a3spatialPoseEncode(a3_SpatialPoseCompact *spatialPose_out, const a3_SpatialPose *spatialPose_in)
+{
+	if (spatialPose_out && spatialPose_in)
+	{
+		const a3real *q = spatialPose_in->orientation.v;
+		const a3vec3 scale = spatialPose_in->scale;
+		a3real sign, c;
+		a3ui32 i, j, largest = 0, quant[3];
+
+		// drop largest component, flipping the quaternion so it is positive
+		for (i = 1; i < 4; ++i)
+			if (a3absolute(q[i]) > a3absolute(q[largest]))
+				largest = i;
+		sign = q[largest] < a3real_zero ? -a3real_one : a3real_one;
+		for (i = j = 0; i < 4; ++i)
+			if (i != largest)
+			{
+				c = (q[i] * sign * a3spatialPoseInternalQuantRange + a3real_one) * a3real_half;
+				quant[j++] = (a3ui32)(a3clamp(a3real_zero, a3real_one, c) * (a3real)a3spatialPoseInternalQuantMax + a3real_half);
+			}
+		spatialPose_out->orientation[0] = (a3ui16)(((largest >> 1) << 15) | quant[0]);
+		spatialPose_out->orientation[1] = (a3ui16)(((largest & 1) << 15) | quant[1]);
+		spatialPose_out->orientation[2] = (a3ui16)quant[2];
+
+		spatialPose_out->translation[0] = a3spatialPoseInternalEncodeHalf(spatialPose_in->translation.x);
+		spatialPose_out->translation[1] = a3spatialPoseInternalEncodeHalf(spatialPose_in->translation.y);
+		spatialPose_out->translation[2] = a3spatialPoseInternalEncodeHalf(spatialPose_in->translation.z);
+		spatialPose_out->scale = a3spatialPoseInternalEncodeHalf((scale.x + scale.y + scale.z) / (a3real)3);
+		spatialPose_out->reserved = 0;
+		return (scale.x == scale.y && scale.y == scale.z);
+	}
+	return -1;
+}
+
+// decode single node pose from compact form
+inline a3i32 a3spatialPoseDecode(a3_SpatialPose *spatialPose_out, const a3_SpatialPoseCompact *spatialPose_in)
+{
+	if (spatialPose_out && spatialPose_in)
+	{
+		const a3real scale = a3real_one / (a3real)a3spatialPoseInternalQuantMax;
+		const a3real range = a3real_one / a3spatialPoseInternalQuantRange;
+		const a3ui32 largest = ((spatialPose_in->orientation[0] >> 15) << 1) | (spatialPose_in->orientation[1] >> 15);
+		const a3real a = ((a3real)(spatialPose_in->orientation[0] & 0x7fff) * scale * a3real_two - a3real_one) * range;
+		const a3real b = ((a3real)(spatialPose_in->orientation[1] & 0x7fff) * scale * a3real_two - a3real_one) * range;
+		const a3real c = ((a3real)(spatialPose_in->orientation[2] & 0x7fff) * scale * a3real_two - a3real_one) * range;
+		const a3real d = a3spatialPoseInternalSqrt(a3maximum(a3real_zero, a3real_one - a * a - b * b - c * c));
+		a3real *q = spatialPose_out->orientation.v;
+		q[0] = largest == 0 ? d : a;
+		q[1] = largest == 0 ? a : largest == 1 ? d : b;
+		q[2] = largest <= 1 ? b : largest == 2 ? d : c;
+		q[3] = largest == 3 ? d : c;
+
+		spatialPose_out->translation.x = a3spatialPoseInternalDecodeHalf(spatialPose_in->translation[0]);
+		spatialPose_out->translation.y = a3spatialPoseInternalDecodeHalf(spatialPose_in->translation[1]);
+		spatialPose_out->translation.z = a3spatialPoseInternalDecodeHalf(spatialPose_in->translation[2]);
+		spatialPose_out->scale.x = spatialPose_out->scale.y = spatialPose_out->scale.z = a3spatialPoseInternalDecodeHalf(spatialPose_in->scale);
+		return 1;
+	}
+	return -1;
+}
+
+// get number of blocks needed to hold a number of poses
+inline a3i32 a3spatialPoseBlockGetCount(const a3ui32 count)
+{
+	return ((count + a3poseBlock_size - 1) / a3poseBlock_size);
+}
 
 
 //-----------------------------------------------------------------------------
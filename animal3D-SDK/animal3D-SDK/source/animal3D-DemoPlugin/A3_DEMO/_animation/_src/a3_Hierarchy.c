@@ -43,12 +43,40 @@ inline a3ret a3hierarchyInternalGetIndex(const a3_Hierarchy *hierarchy, const a3
 	return -1;
 }
 
-inline void a3hierarchyInternalSetNode(a3_HierarchyNode *node, const a3ui32 index, const a3i32 parentIndex, const a3byte name[a3node_nameSize])
+inline void a3hierarchyInternalSetNode(a3_HierarchyNode *node, a3i16 *nodeParentIndex, const a3ui32 index, const a3i32 parentIndex, const a3byte name[a3node_nameSize])
 {
 	strncpy(node->name, name, a3node_nameSize);
 	node->name[a3node_nameSize - 1] = 0;
 	node->index = index;
-	node->parentIndex = parentIndex;
+	*nodeParentIndex = (a3i16)parentIndex;
+}
+
+// count nodes evaluated at each detail level, assuming LOD order
+inline void a3hierarchyInternalCountLOD(a3_Hierarchy *hierarchy)
+{
+	a3ui32 i, lod;
+	for (lod = 0; lod < a3node_lodMax; ++lod)
+	{
+		for (i = 0; i < hierarchy->numNodes && hierarchy->nodes[i].maxLOD >= (a3i32)lod; ++i);
+		hierarchy->lodNodeCount[lod] = i;
+	}
+}
+
+// size of topology block, padded so that node metadata stays aligned
+inline a3ui32 a3hierarchyInternalGetTopologySize(const a3ui32 numNodes)
+{
+	return ((sizeof(a3i16) * numNodes + 15) & ~15);
+}
+
+// allocate topology and node metadata as a single block, topology first
+inline a3ui32 a3hierarchyInternalAlloc(a3_Hierarchy *hierarchy, const a3ui32 numNodes)
+{
+	const a3ui32 topologySize = a3hierarchyInternalGetTopologySize(numNodes);
+	const a3ui32 dataSize = topologySize + sizeof(a3_HierarchyNode) * numNodes;
+	hierarchy->parentIndex = (a3i16 *)malloc(dataSize);
+	hierarchy->nodes = (a3_HierarchyNode *)((a3byte *)hierarchy->parentIndex + topologySize);
+	hierarchy->numNodes = numNodes;
+	return dataSize;
 }
 
 
@@ -56,16 +84,20 @@ inline void a3hierarchyInternalSetNode(a3_HierarchyNode *node, const a3ui32 inde
 
 a3ret a3hierarchyCreate(a3_Hierarchy *hierarchy_out, const a3ui32 numNodes, const a3byte **names_opt)
 {
-	if (hierarchy_out && numNodes)
+	if (hierarchy_out && numNodes && numNodes <= a3node_countMax)
 	{
 		if (!hierarchy_out->nodes)
 		{
-			const a3ui32 dataSize = sizeof(a3_HierarchyNode) * numNodes;
+			const a3ui32 dataSize = a3hierarchyInternalAlloc(hierarchy_out, numNodes);
 			a3ui32 i;
 			const a3byte *tmpName;
-			hierarchy_out->nodes = (a3_HierarchyNode *)malloc(dataSize);
-			memset(hierarchy_out->nodes, 0, dataSize);
-			hierarchy_out->numNodes = numNodes;
+			memset(hierarchy_out->parentIndex, 0, dataSize);
+			for (i = 0; i < numNodes; ++i)
+			{
+				hierarchy_out->nodes[i].index = i;
+				hierarchy_out->nodes[i].maxLOD = a3node_lodMax - 1;
+			}
+			a3hierarchyInternalCountLOD(hierarchy_out);
 			if (names_opt)
 			{
 				for (i = 0; i < numNodes; ++i)
@@ -98,7 +130,7 @@ a3ret a3hierarchySetNode(const a3_Hierarchy *hierarchy, const a3ui32 index, cons
 			if ((a3i32)index > parentIndex)
 			{
 				node = hierarchy->nodes + index;
-				a3hierarchyInternalSetNode(node, index, parentIndex, name);
+				a3hierarchyInternalSetNode(node, hierarchy->parentIndex + index, index, parentIndex, name);
 				return index;
 			}
 			else
@@ -108,6 +140,65 @@ a3ret a3hierarchySetNode(const a3_Hierarchy *hierarchy, const a3ui32 index, cons
 	return -1;
 }
 
+a3ret a3hierarchySetNodeLOD(const a3_Hierarchy *hierarchy, const a3ui32 index, const a3ui32 maxLOD)
+{
+	if (hierarchy)
+	{
+		if (hierarchy->nodes && index < hierarchy->numNodes && maxLOD < a3node_lodMax)
+		{
+			hierarchy->nodes[index].maxLOD = maxLOD;
+			return index;
+		}
+	}
+	return -1;
+}
+
+a3ret a3hierarchyReorderLOD(a3_Hierarchy *hierarchy, a3i32 remap_out_opt[])
+{
+	a3_Hierarchy reordered = { 0 };
+	a3i32 *remap;
+	a3i32 i, j, lod, n;
+	if (hierarchy)
+	{
+		if (hierarchy->nodes)
+		{
+			n = hierarchy->numNodes;
+			remap = remap_out_opt ? remap_out_opt : (a3i32 *)malloc(sizeof(a3i32) * n);
+
+			// clamp each node's level to its parent's
+			for (i = 0; i < n; ++i)
+				if ((j = hierarchy->parentIndex[i]) >= 0 && hierarchy->nodes[i].maxLOD > hierarchy->nodes[j].maxLOD)
+					hierarchy->nodes[i].maxLOD = hierarchy->nodes[j].maxLOD;
+
+			// stable partition from coarsest level down; since levels do not 
+			//	increase from parent to child, parents stay ahead of children
+			a3hierarchyInternalAlloc(&reordered, n);
+			for (lod = a3node_lodMax - 1, j = 0; lod >= 0; --lod)
+				for (i = 0; i < n; ++i)
+					if (hierarchy->nodes[i].maxLOD == lod)
+						remap[i] = j++;
+
+			// move data
+			for (i = 0; i < n; ++i)
+			{
+				j = remap[i];
+				reordered.nodes[j] = hierarchy->nodes[i];
+				reordered.nodes[j].index = j;
+				reordered.parentIndex[j] = hierarchy->parentIndex[i] >= 0 ? (a3i16)remap[hierarchy->parentIndex[i]] : -1;
+			}
+			free(hierarchy->parentIndex);
+			hierarchy->parentIndex = reordered.parentIndex;
+			hierarchy->nodes = reordered.nodes;
+			a3hierarchyInternalCountLOD(hierarchy);
+
+			if (!remap_out_opt)
+				free(remap);
+			return hierarchy->lodNodeCount[a3node_lodMax - 1];
+		}
+	}
+	return -1;
+}
+
 a3ret a3hierarchyGetNodeIndex(const a3_Hierarchy *hierarchy, const a3byte name[a3node_nameSize])
 {
 	if (hierarchy)
@@ -143,6 +234,7 @@ a3ret a3hierarchySaveBinary(const a3_Hierarchy *hierarchy, const a3_FileStream *
 			if (fp)
 			{
 				ret += (a3ui32)fwrite(&hierarchy->numNodes, 1, sizeof(a3ui32), fp);
+				ret += (a3ui32)fwrite(hierarchy->parentIndex, 1, sizeof(a3i16) * hierarchy->numNodes, fp);
 				ret += (a3ui32)fwrite(hierarchy->nodes, 1, sizeof(a3_HierarchyNode) * hierarchy->numNodes, fp);
 			}
 			return ret;
@@ -155,7 +247,7 @@ a3ret a3hierarchyLoadBinary(a3_Hierarchy *hierarchy, const a3_FileStream *fileSt
 {
 	FILE *fp;
 	a3ui32 ret = 0;
-	a3ui32 dataSize = 0;
+	a3ui32 numNodes = 0;
 	if (hierarchy && fileStream)
 	{
 		if (!hierarchy->nodes)
@@ -163,11 +255,16 @@ a3ret a3hierarchyLoadBinary(a3_Hierarchy *hierarchy, const a3_FileStream *fileSt
 			fp = fileStream->stream;
 			if (fp)
 			{
-				ret += (a3ui32)fread(&hierarchy->numNodes, 1, sizeof(a3ui32), fp);
-
-				dataSize = sizeof(a3_HierarchyNode) * hierarchy->numNodes;
-				hierarchy->nodes = (a3_HierarchyNode *)malloc(dataSize);
-				ret += (a3ui32)fread(hierarchy->nodes, 1, dataSize, fp);
+				ret += (a3ui32)fread(&numNodes, 1, sizeof(a3ui32), fp);
+				if (numNodes && numNodes <= a3node_countMax)
+				{
+					a3hierarchyInternalAlloc(hierarchy, numNodes);
+					ret += (a3ui32)fread(hierarchy->parentIndex, 1, sizeof(a3i16) * numNodes, fp);
+					ret += (a3ui32)fread(hierarchy->nodes, 1, sizeof(a3_HierarchyNode) * numNodes, fp);
+					a3hierarchyInternalCountLOD(hierarchy);
+				}
+				else
+					return 0;
 			}
 			return ret;
 		}
@@ -183,6 +280,7 @@ a3ret a3hierarchyCopyToString(const a3_Hierarchy *hierarchy, a3byte *str)
 		if (hierarchy->nodes)
 		{
 			str = (a3byte *)((a3ui32 *)memcpy(str, &hierarchy->numNodes, sizeof(a3ui32)) + 1);
+			str = (a3byte *)((a3i16 *)memcpy(str, hierarchy->parentIndex, sizeof(a3i16) * hierarchy->numNodes) + hierarchy->numNodes);
 			str = (a3byte *)((a3_HierarchyNode *)memcpy(str, hierarchy->nodes, sizeof(a3_HierarchyNode) * hierarchy->numNodes) + hierarchy->numNodes);
 
 			// done
@@ -196,17 +294,25 @@ a3ret a3hierarchyCopyFromString(a3_Hierarchy *hierarchy, const a3byte *str)
 {
 	const a3byte *const start = str;
 	a3ui32 dataSize = 0;
+	a3ui32 numNodes = 0;
 	if (hierarchy && str)
 	{
 		if (!hierarchy->nodes)
 		{
-			memcpy(&hierarchy->numNodes, str, sizeof(a3ui32));
+			memcpy(&numNodes, str, sizeof(a3ui32));
 			str += sizeof(a3ui32);
+			if (!numNodes || numNodes > a3node_countMax)
+				return 0;
+			a3hierarchyInternalAlloc(hierarchy, numNodes);
+
+			dataSize = sizeof(a3i16) * numNodes;
+			memcpy(hierarchy->parentIndex, str, dataSize);
+			str += dataSize;
 
-			dataSize = sizeof(a3_HierarchyNode) * hierarchy->numNodes;
-			hierarchy->nodes = (a3_HierarchyNode *)malloc(dataSize);
+			dataSize = sizeof(a3_HierarchyNode) * numNodes;
 			memcpy(hierarchy->nodes, str, dataSize);
 			str += dataSize;
+			a3hierarchyInternalCountLOD(hierarchy);
 
 			// done
 			return (a3i32)(str - start);
@@ -223,6 +329,7 @@ a3ret a3hierarchyGetStringSize(const a3_Hierarchy *hierarchy)
 		{
 			const a3ui32 dataSize
 				= sizeof(a3ui32)
+				+ sizeof(a3i16) * hierarchy->numNodes
 				+ sizeof(a3_HierarchyNode) * hierarchy->numNodes;
 			return dataSize;
 		}
@@ -236,7 +343,8 @@ a3ret a3hierarchyRelease(a3_Hierarchy *hierarchy)
 	{
 		if (hierarchy->nodes)
 		{
-			free(hierarchy->nodes);
+			free(hierarchy->parentIndex);
+			hierarchy->parentIndex = 0;
 			hierarchy->nodes = 0;
 			hierarchy->numNodes = 0;
 			return 1;
@@ -27,18 +27,358 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef A3_SPATIALPOSE_SSE
+#include <xmmintrin.h>
+#endif	// A3_SPATIALPOSE_SSE
+
+
+// alignment of hierarchy state data block (cache line)
+#define A3_HIERARCHYSTATE_ALIGN		64
+
 
 //-----------------------------------------------------------------------------
 
 // initialize pose set given an initialized hierarchy and key pose count
 a3i32 a3hierarchyPoseGroupCreate(a3_HierarchyPoseGroup *poseGroup_out, const a3_Hierarchy *hierarchy, const a3ui32 poseCount)
 {
+	// validate params and initialization states
+	//	(output is not yet initialized, hierarchy is initialized)
+	if (poseGroup_out && hierarchy && !poseGroup_out->hierarchy && hierarchy->nodes && poseCount)
+	{
+		// determine memory requirements: hierarchy poses, then spatial poses, 
+		//	then channels
+		const a3ui32 nodeCount = hierarchy->numNodes;
+		const a3ui32 spatialPoseCount = poseCount * nodeCount;
+		const a3ui32 dataSize = sizeof(a3_HierarchyPose) * poseCount + sizeof(a3_SpatialPose) * spatialPoseCount + sizeof(a3_SpatialPoseChannel) * nodeCount;
+		a3ui32 i;
+
+		// allocate everything (one malloc)
+		poseGroup_out->hpose = (a3_HierarchyPose *)malloc(dataSize);
+		poseGroup_out->spatialPosePool = (a3_SpatialPose *)(poseGroup_out->hpose + poseCount);
+		poseGroup_out->channel = (a3_SpatialPoseChannel *)(poseGroup_out->spatialPosePool + spatialPoseCount);
+
+		// set pointers
+		poseGroup_out->hierarchy = hierarchy;
+		poseGroup_out->hposeCount = poseCount;
+		for (i = 0; i < poseCount; ++i)
+			poseGroup_out->hpose[i].spatialPose = poseGroup_out->spatialPosePool + i * nodeCount;
+
+		poseGroup_out->compactPosePool = 0;
+
+		// reset all data
+		for (i = 0; i < spatialPoseCount; ++i)
+			a3spatialPoseReset(poseGroup_out->spatialPosePool + i);
+		for (i = 0; i < nodeCount; ++i)
+			poseGroup_out->channel[i] = a3poseChannel_all;
+
+		// done
+		return poseCount;
+	}
 	return -1;
 }
 
 // release pose set
 a3i32 a3hierarchyPoseGroupRelease(a3_HierarchyPoseGroup *poseGroup)
 {
+	// validate param exists and is initialized
+	if (poseGroup && poseGroup->hierarchy)
+	{
+		// release everything (one free)
+		free(poseGroup->hpose);
+
+		// reset pointers
+		poseGroup->hierarchy = 0;
+		poseGroup->hpose = 0;
+		poseGroup->spatialPosePool = 0;
+		poseGroup->channel = 0;
+		poseGroup->compactPosePool = 0;
+		poseGroup->hposeCount = 0;
+
+		// done
+		return 1;
+	}
+	return -1;
+}
+
+// compress pose group
+a3i32 a3hierarchyPoseGroupCompress(a3_HierarchyPoseGroup *poseGroup)
+{
+	if (poseGroup && poseGroup->hierarchy && !poseGroup->compactPosePool)
+	{
+		// new layout: hierarchy poses, base pose, channels, compact poses
+		const a3ui32 nodeCount = poseGroup->hierarchy->numNodes;
+		const a3ui32 poseCount = poseGroup->hposeCount;
+		const a3ui32 spatialPoseCount = poseCount * nodeCount;
+		const a3ui32 dataSize = sizeof(a3_HierarchyPose) * poseCount + sizeof(a3_SpatialPose) * nodeCount + sizeof(a3_SpatialPoseChannel) * nodeCount + sizeof(a3_SpatialPoseCompact) * spatialPoseCount;
+		a3_HierarchyPose *hpose = (a3_HierarchyPose *)malloc(dataSize);
+		a3_SpatialPose *spatialPosePool = (a3_SpatialPose *)(hpose + poseCount);
+		a3_SpatialPoseChannel *channel = (a3_SpatialPoseChannel *)(spatialPosePool + nodeCount);
+		a3_SpatialPoseCompact *compactPosePool = (a3_SpatialPoseCompact *)(channel + nodeCount);
+		a3ui32 i;
+
+		// encode; compact poses only hold uniform scale, so refuse rather 
+		//	than lose data
+		for (i = 0; i < spatialPoseCount; ++i)
+			if (a3spatialPoseEncode(compactPosePool + i, poseGroup->spatialPosePool + i) != 1)
+			{
+				free(hpose);
+				return -1;
+			}
+
+		// move data
+		memcpy(spatialPosePool, poseGroup->spatialPosePool, sizeof(a3_SpatialPose) * nodeCount);
+		memcpy(channel, poseGroup->channel, sizeof(a3_SpatialPoseChannel) * nodeCount);
+		hpose[0].spatialPose = spatialPosePool;
+		for (i = 1; i < poseCount; ++i)
+			hpose[i].spatialPose = 0;
+		free(poseGroup->hpose);
+
+		poseGroup->hpose = hpose;
+		poseGroup->spatialPosePool = spatialPosePool;
+		poseGroup->channel = channel;
+		poseGroup->compactPosePool = compactPosePool;
+		return poseCount;
+	}
+	return -1;
+}
+
+// get a full hierarchy pose from a group
+a3i32 a3hierarchyPoseGroupGetPose(const a3_HierarchyPose *pose_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 poseIndex)
+{
+	if (pose_out && pose_out->spatialPose && poseGroup && poseGroup->hierarchy && poseIndex < poseGroup->hposeCount)
+	{
+		const a3ui32 nodeCount = poseGroup->hierarchy->numNodes;
+		if (poseGroup->compactPosePool)
+		{
+			// decode in chunks of blocks, then unpack
+			a3_SpatialPoseBlock block[16];
+			const a3_SpatialPoseCompact *compactPose = poseGroup->compactPosePool + poseIndex * nodeCount;
+			const a3ui32 chunk = sizeof(block) / sizeof(*block) * a3poseBlock_size;
+			a3ui32 i, n;
+			for (i = 0; i < nodeCount; i += chunk)
+			{
+				n = a3minimum(nodeCount - i, chunk);
+				a3spatialPoseDecodeBatch(block, compactPose + i, n);
+				a3spatialPoseBlockUnpack(pose_out->spatialPose + i, block, n);
+			}
+		}
+		else
+			memcpy(pose_out->spatialPose, poseGroup->hpose[poseIndex].spatialPose, sizeof(a3_SpatialPose) * nodeCount);
+		return nodeCount;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// create joint limits
+a3i32 a3hierarchyJointLimitsCreate(a3_HierarchyJointLimits *limits_out, const a3_Hierarchy *hierarchy)
+{
+	if (limits_out && !limits_out->hierarchy && hierarchy && hierarchy->numNodes)
+	{
+		// 6 arrays of one value per node (one malloc)
+		const a3ui32 nodeCount = hierarchy->numNodes;
+		a3ui32 i;
+		limits_out->twistMinSin = (a3real *)malloc(sizeof(a3real) * nodeCount * 6);
+		limits_out->twistMinCos = limits_out->twistMinSin + nodeCount;
+		limits_out->twistMaxSin = limits_out->twistMinCos + nodeCount;
+		limits_out->twistMaxCos = limits_out->twistMaxSin + nodeCount;
+		limits_out->swingMaxSin = limits_out->twistMaxCos + nodeCount;
+		limits_out->swingMaxCos = limits_out->swingMaxSin + nodeCount;
+		limits_out->hierarchy = hierarchy;
+
+		// unlimited: half angles at +/-90 degrees never clamp
+		for (i = 0; i < nodeCount; ++i)
+			a3hierarchyJointLimitsSetNode(limits_out, i, -a3real_oneeighty, a3real_oneeighty, a3real_oneeighty);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// release joint limits
+a3i32 a3hierarchyJointLimitsRelease(a3_HierarchyJointLimits *limits)
+{
+	if (limits && limits->hierarchy)
+	{
+		free(limits->twistMinSin);
+		limits->hierarchy = 0;
+		limits->twistMinSin = limits->twistMinCos = limits->twistMaxSin = limits->twistMaxCos = 0;
+		limits->swingMaxSin = limits->swingMaxCos = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// set node limits
+a3i32 a3hierarchyJointLimitsSetNode(const a3_HierarchyJointLimits *limits, const a3ui32 index, const a3real twistMin, const a3real twistMax, const a3real swingMax)
+{
+	if (limits && limits->hierarchy && index < limits->hierarchy->numNodes && twistMin <= twistMax)
+	{
+		const a3real tMin = a3clamp(-a3real_oneeighty, a3real_oneeighty, twistMin) * a3real_half;
+		const a3real tMax = a3clamp(-a3real_oneeighty, a3real_oneeighty, twistMax) * a3real_half;
+		const a3real sMax = a3clamp(a3real_zero, a3real_oneeighty, swingMax) * a3real_half;
+		limits->twistMinSin[index] = a3sind(tMin);
+		limits->twistMinCos[index] = a3cosd(tMin);
+		limits->twistMaxSin[index] = a3sind(tMax);
+		limits->twistMaxCos[index] = a3cosd(tMax);
+		limits->swingMaxSin[index] = a3sind(sMax);
+		limits->swingMaxCos[index] = a3cosd(sMax);
+		return index;
+	}
+	return -1;
+}
+
+
+// clamp one orientation to swing-twist limits; returns 1 if clamped
+//	q = swing * twist, twist = (tx, 0, 0, tw) about x, swing = (0, sy, sz, sw); 
+//	with q flipped so w >= 0, both half angles are in [-90, 90] degrees and 
+//	the sine of each is monotonic, so limits compare on sines alone
+inline a3boolean a3hierarchyJointLimitsInternalClamp(a3vec4 *q, const a3_HierarchyJointLimits *limits, const a3ui32 i)
+{
+	const a3real flip = q->w < a3real_zero ? -a3real_one : a3real_one;
+	const a3real qx = q->x * flip, qy = q->y * flip, qz = q->z * flip, qw = q->w * flip;
+	const a3real n = a3sqrt(qx * qx + qw * qw);
+	a3real tx = n > a3real_zero ? qx / n : a3real_zero, tw = n > a3real_zero ? qw / n : a3real_one;
+	a3real sy = tw * qy - tx * qz, sz = tw * qz + tx * qy, sw = n, len, k;
+	a3boolean clamped = 0;
+
+	// twist
+	if (tx < limits->twistMinSin[i])
+	{
+		tx = limits->twistMinSin[i];
+		tw = limits->twistMinCos[i];
+		clamped = 1;
+	}
+	else if (tx > limits->twistMaxSin[i])
+	{
+		tx = limits->twistMaxSin[i];
+		tw = limits->twistMaxCos[i];
+		clamped = 1;
+	}
+
+	// swing
+	len = a3sqrt(sy * sy + sz * sz);
+	if (len > limits->swingMaxSin[i])
+	{
+		k = limits->swingMaxSin[i] / len;
+		sy *= k;
+		sz *= k;
+		sw = limits->swingMaxCos[i];
+		clamped = 1;
+	}
+
+	// recombine
+	if (clamped)
+	{
+		q->x = sw * tx;
+		q->y = tw * sy + tx * sz;
+		q->z = tw * sz - tx * sy;
+		q->w = sw * tw;
+	}
+	return clamped;
+}
+
+#ifdef A3_SPATIALPOSE_SSE
+// clamp 4 consecutive orientations, same steps as above; returns lane mask
+inline a3i32 a3hierarchyJointLimitsInternalClamp4(a3_SpatialPose *pose, const a3_HierarchyJointLimits *limits, const a3ui32 i)
+{
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(a3real_one);
+	__m128 qx = _mm_loadu_ps(pose[0].orientation.v), qy = _mm_loadu_ps(pose[1].orientation.v);
+	__m128 qz = _mm_loadu_ps(pose[2].orientation.v), qw = _mm_loadu_ps(pose[3].orientation.v);
+	__m128 flip, n, valid, nInv, tx, tw, sy, sz, sw, len, lo, hi, over, k, clamped, x, y, z, w;
+	a3i32 mask;
+
+	// orientations to SoA, flipped so w >= 0
+	_MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+	flip = _mm_and_ps(_mm_cmplt_ps(qw, zero), _mm_set1_ps(-0.0f));
+	x = _mm_xor_ps(qx, flip);
+	y = _mm_xor_ps(qy, flip);
+	z = _mm_xor_ps(qz, flip);
+	w = _mm_xor_ps(qw, flip);
+
+	// split
+	n = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(w, w)));
+	valid = _mm_cmpgt_ps(n, zero);
+	nInv = _mm_and_ps(valid, _mm_div_ps(one, n));
+	tx = _mm_mul_ps(x, nInv);
+	tw = _mm_or_ps(_mm_mul_ps(w, nInv), _mm_andnot_ps(valid, one));
+	sy = _mm_sub_ps(_mm_mul_ps(tw, y), _mm_mul_ps(tx, z));
+	sz = _mm_add_ps(_mm_mul_ps(tw, z), _mm_mul_ps(tx, y));
+	sw = n;
+
+	// twist
+	lo = _mm_cmplt_ps(tx, _mm_loadu_ps(limits->twistMinSin + i));
+	hi = _mm_cmpgt_ps(tx, _mm_loadu_ps(limits->twistMaxSin + i));
+	tx = _mm_or_ps(_mm_andnot_ps(_mm_or_ps(lo, hi), tx), _mm_or_ps(_mm_and_ps(lo, _mm_loadu_ps(limits->twistMinSin + i)), _mm_and_ps(hi, _mm_loadu_ps(limits->twistMaxSin + i))));
+	tw = _mm_or_ps(_mm_andnot_ps(_mm_or_ps(lo, hi), tw), _mm_or_ps(_mm_and_ps(lo, _mm_loadu_ps(limits->twistMinCos + i)), _mm_and_ps(hi, _mm_loadu_ps(limits->twistMaxCos + i))));
+
+	// swing
+	len = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(sy, sy), _mm_mul_ps(sz, sz)));
+	over = _mm_cmpgt_ps(len, _mm_loadu_ps(limits->swingMaxSin + i));
+	k = _mm_or_ps(_mm_and_ps(over, _mm_div_ps(_mm_loadu_ps(limits->swingMaxSin + i), len)), _mm_andnot_ps(over, one));
+	sy = _mm_mul_ps(sy, k);
+	sz = _mm_mul_ps(sz, k);
+	sw = _mm_or_ps(_mm_and_ps(over, _mm_loadu_ps(limits->swingMaxCos + i)), _mm_andnot_ps(over, sw));
+
+	// recombine clamped lanes, others keep their exact input
+	clamped = _mm_or_ps(_mm_or_ps(lo, hi), over);
+	mask = _mm_movemask_ps(clamped);
+	if (mask)
+	{
+		x = _mm_or_ps(_mm_and_ps(clamped, _mm_mul_ps(sw, tx)), _mm_andnot_ps(clamped, qx));
+		y = _mm_or_ps(_mm_and_ps(clamped, _mm_add_ps(_mm_mul_ps(tw, sy), _mm_mul_ps(tx, sz))), _mm_andnot_ps(clamped, qy));
+		z = _mm_or_ps(_mm_and_ps(clamped, _mm_sub_ps(_mm_mul_ps(tw, sz), _mm_mul_ps(tx, sy))), _mm_andnot_ps(clamped, qz));
+		w = _mm_or_ps(_mm_and_ps(clamped, _mm_mul_ps(sw, tw)), _mm_andnot_ps(clamped, qw));
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		_mm_storeu_ps(pose[0].orientation.v, x);
+		_mm_storeu_ps(pose[1].orientation.v, y);
+		_mm_storeu_ps(pose[2].orientation.v, z);
+		_mm_storeu_ps(pose[3].orientation.v, w);
+	}
+	return mask;
+}
+#endif	// A3_SPATIALPOSE_SSE
+
+// clamp pose to limits, optionally mark clamped nodes of a state dirty: 
+//	clamped nodes are flagged during the pass, then one sweep from the 
+//	first of them propagates to all descendants
+inline a3i32 a3hierarchyJointLimitsInternalApply(a3_SpatialPose *pose, const a3_HierarchyJointLimits *limits, const a3ui32 nodeCount, const a3_HierarchyState *state_opt)
+{
+	a3ubyte *dirty = state_opt ? state_opt->nodeDirty : 0;
+	a3ui32 i = 0, clamped = 0, first = 0;
+#ifdef A3_SPATIALPOSE_SSE
+	a3i32 mask;
+	a3ui32 k;
+	for (; i + 4 <= nodeCount; i += 4)
+		if ((mask = a3hierarchyJointLimitsInternalClamp4(pose + i, limits, i)))
+			for (k = 0; k < 4; ++k)
+				if (mask & (1 << k))
+				{
+					if (dirty)
+						dirty[i + k] = a3hierarchyStateDirty_all;
+					if (!clamped++)
+						first = i + k;
+				}
+#endif	// A3_SPATIALPOSE_SSE
+	for (; i < nodeCount; ++i)
+		if (a3hierarchyJointLimitsInternalClamp(&pose[i].orientation, limits, i))
+		{
+			if (dirty)
+				dirty[i] = a3hierarchyStateDirty_all;
+			if (!clamped++)
+				first = i;
+		}
+	if (dirty && clamped)
+		a3hierarchyStateMarkDirty(state_opt, first);
+	return clamped;
+}
+
+// clamp pose to limits
+a3i32 a3hierarchyPoseApplyLimits(const a3_HierarchyPose *pose_inout, const a3_HierarchyJointLimits *limits, const a3ui32 nodeCount)
+{
+	if (pose_inout && pose_inout->spatialPose && limits && limits->hierarchy && nodeCount <= limits->hierarchy->numNodes)
+		return a3hierarchyJointLimitsInternalApply(pose_inout->spatialPose, limits, nodeCount, 0);
 	return -1;
 }
 
@@ -48,18 +388,213 @@ a3i32 a3hierarchyPoseGroupRelease(a3_HierarchyPoseGroup *poseGroup)
 // initialize hierarchy state given an initialized hierarchy
 a3i32 a3hierarchyStateCreate(a3_HierarchyState *state_out, const a3_HierarchyPoseGroup *poseGroup)
 {
+	// validate params and initialization states
+	//	(output is not yet initialized, pose group is initialized)
+	if (state_out && poseGroup && !state_out->poseGroup && poseGroup->hierarchy && poseGroup->hpose)
+	{
+		// determine memory requirements: 
+		//	matrix arrays first so every array starts on an aligned boundary, 
+		//	then the sampled, evaluated and object poses, then dirty flags
+		const a3ui32 nodeCount = poseGroup->hierarchy->numNodes;
+		const a3ui32 transformSize = sizeof(a3mat4) * nodeCount;
+		const a3ui32 dataSize = transformSize * 4 + sizeof(a3_SpatialPose) * nodeCount * 4 + sizeof(a3ubyte) * nodeCount;
+		a3address base;
+		a3ui32 i;
+
+		// allocate everything (one malloc) and align
+		state_out->data = malloc(dataSize + A3_HIERARCHYSTATE_ALIGN);
+		base = ((a3address)state_out->data + (A3_HIERARCHYSTATE_ALIGN - 1)) & ~(a3address)(A3_HIERARCHYSTATE_ALIGN - 1);
+
+		// set pointers
+		state_out->poseGroup = poseGroup;
+		state_out->localSpace->transform = (a3mat4 *)base;
+		state_out->objectSpace->transform = state_out->localSpace->transform + nodeCount;
+		state_out->objectSpaceInverse->transform = state_out->objectSpace->transform + nodeCount;
+		state_out->objectSpaceBindToCurrent->transform = state_out->objectSpaceInverse->transform + nodeCount;
+		state_out->samplePose->spatialPose = (a3_SpatialPose *)(state_out->objectSpaceBindToCurrent->transform + nodeCount);
+		state_out->evaluatedPose[0].spatialPose = state_out->samplePose->spatialPose + nodeCount;
+		state_out->evaluatedPose[1].spatialPose = state_out->evaluatedPose[0].spatialPose + nodeCount;
+		state_out->objectPose->spatialPose = state_out->evaluatedPose[1].spatialPose + nodeCount;
+		state_out->nodeDirty = (a3ubyte *)(state_out->objectPose->spatialPose + nodeCount);
+
+		// reset all data: sample starts at base pose, matrices at identity, 
+		//	everything needs a first update
+		for (i = 0; i < 4; ++i)
+			memcpy(state_out->samplePose->spatialPose + i * nodeCount, poseGroup->hpose->spatialPose, sizeof(a3_SpatialPose) * nodeCount);
+		for (i = 0; i < nodeCount * 4; ++i)
+			a3real4x4SetIdentity(state_out->localSpace->transform[i].m);
+		a3hierarchyStateMarkDirtyAll(state_out);
+		state_out->lod = 0;
+		state_out->scaleMode = a3hierarchyStateScale_full;
+		state_out->updateInterval = state_out->updateTime = a3real_zero;
+
+		// done
+		return nodeCount;
+	}
 	return -1;
 }
 
 // release hierarchy state
 a3i32 a3hierarchyStateRelease(a3_HierarchyState *state)
 {
+	// validate param exists and is initialized
+	if (state && state->poseGroup)
+	{
+		// release everything (one free)
+		free(state->data);
+
+		// reset pointers
+		state->poseGroup = 0;
+		state->samplePose->spatialPose = 0;
+		state->evaluatedPose[0].spatialPose = 0;
+		state->evaluatedPose[1].spatialPose = 0;
+		state->objectPose->spatialPose = 0;
+		state->localSpace->transform = 0;
+		state->objectSpace->transform = 0;
+		state->objectSpaceInverse->transform = 0;
+		state->objectSpaceBindToCurrent->transform = 0;
+		state->nodeDirty = 0;
+		state->data = 0;
+		state->lod = 0;
+		state->updateInterval = state->updateTime = a3real_zero;
+
+		// done
+		return 1;
+	}
 	return -1;
 }
 
 
 //-----------------------------------------------------------------------------
 
+// clamp sampled pose to joint limits
+a3i32 a3hierarchyStateApplyLimits(const a3_HierarchyState *state, const a3_HierarchyJointLimits *limits)
+{
+	if (state && state->poseGroup && limits && limits->hierarchy == state->poseGroup->hierarchy)
+		return a3hierarchyJointLimitsInternalApply(state->samplePose->spatialPose, limits, state->poseGroup->hierarchy->lodNodeCount[state->lod], state);
+	return -1;
+}
+
+// set detail level
+a3i32 a3hierarchyStateSetLOD(a3_HierarchyState *state, const a3ui32 lod)
+{
+	if (state && state->poseGroup && lod < a3node_lodMax)
+	{
+		const a3ui32 *lodNodeCount = state->poseGroup->hierarchy->lodNodeCount;
+		const a3ui32 countPrev = lodNodeCount[state->lod], count = lodNodeCount[lod];
+		a3ui32 i;
+
+		// nodes dropped by this change hold the base pose from now on
+		if (count < countPrev)
+			for (i = 0; i < 3; ++i)
+				memcpy(state->samplePose->spatialPose + i * state->poseGroup->hierarchy->numNodes + count, 
+					state->poseGroup->hpose->spatialPose + count, sizeof(a3_SpatialPose) * (countPrev - count));
+
+		// nodes whose evaluation changed need a fresh update
+		for (i = a3minimum(count, countPrev); i < a3maximum(count, countPrev); ++i)
+			a3hierarchyStateMarkDirty(state, i);
+
+		state->lod = lod;
+		return count;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// interpolate sampled pose between evaluated poses
+inline void a3hierarchyStateInternalInterpolate(a3_HierarchyState *state, const a3ui32 count)
+{
+	const a3real u = a3minimum(state->updateTime * a3recip(state->updateInterval), a3real_one);
+	a3ui32 i;
+	for (i = 0; i < count; ++i)
+		a3spatialPoseLerp(state->samplePose->spatialPose + i, state->evaluatedPose[0].spatialPose + i, state->evaluatedPose[1].spatialPose + i, u, state->poseGroup->channel[i]);
+	for (i = 0; i < count; ++i)
+		state->nodeDirty[i] = a3hierarchyStateDirty_all;
+}
+
+// set evaluation rate
+a3i32 a3hierarchyStateSetUpdateRate(a3_HierarchyState *state, const a3real rate, const a3real phase)
+{
+	if (state && state->poseGroup && rate >= a3real_zero)
+	{
+		state->updateInterval = rate > a3real_zero ? a3recip(rate) : a3real_zero;
+
+		// start partway into the interval; phase zero evaluates on the next update
+		state->updateTime = state->updateInterval * (a3real_one - phase);
+		return 1;
+	}
+	return -1;
+}
+
+#define a3hierarchyStateInternalRateDivisions	4
+
+// minimum coverage for each rate division, and the divisions themselves: 
+//	full, 1/2, 1/3, then 1/6 below the last threshold (30 Hz: 30, 15, 10, 5)
+static const a3real a3hierarchyStateInternalCoverageMin[a3hierarchyStateInternalRateDivisions - 1] = { (a3real)0.25, (a3real)0.10, (a3real)0.03 };
+static const a3real a3hierarchyStateInternalRateScale[a3hierarchyStateInternalRateDivisions] = { a3real_one, a3real_half, (a3real)(1.0 / 3.0), (a3real)(1.0 / 6.0) };
+
+// choose an evaluation rate from screen coverage or importance
+a3real a3hierarchyStateGetUpdateRateForCoverage(const a3real coverage, const a3real rateFull)
+{
+	a3ui32 i;
+	for (i = 0; i < a3hierarchyStateInternalRateDivisions - 1; ++i)
+		if (coverage >= a3hierarchyStateInternalCoverageMin[i])
+			break;
+	return rateFull * a3hierarchyStateInternalRateScale[i];
+}
+
+// advance update schedule
+a3i32 a3hierarchyStateScheduleUpdate(a3_HierarchyState *state, const a3real dt)
+{
+	// tolerance so accumulated ticks land on the interval despite rounding
+	const a3real tolerance = (a3real)0.001;
+	if (state && state->poseGroup)
+	{
+		const a3boolean due = (state->updateTime + tolerance >= state->updateInterval);
+		if (due)
+		{
+			// keep the remainder so the average rate is exact; drop whole 
+			//	missed intervals so a long frame does not cause a burst
+			state->updateTime -= state->updateInterval;
+			if (state->updateTime + tolerance >= state->updateInterval)
+				state->updateTime = a3real_zero;
+		}
+
+		// time is advanced after the check so interpolation moves forward 
+		//	on the evaluation update as well
+		state->updateTime += dt;
+		if (due)
+			return 1;
+		a3hierarchyStateInternalInterpolate(state, a3hierarchyStateGetActiveNodeCount(state));
+		return 0;
+	}
+	return -1;
+}
+
+// commit newly evaluated sampled pose
+a3i32 a3hierarchyStateScheduleCommit(a3_HierarchyState *state)
+{
+	if (state && state->poseGroup)
+	{
+		const a3ui32 count = a3hierarchyStateGetActiveNodeCount(state);
+		a3_SpatialPose *const evaluatedPrev = state->evaluatedPose[0].spatialPose;
+
+		// rotate evaluated poses and store the new one
+		state->evaluatedPose[0].spatialPose = state->evaluatedPose[1].spatialPose;
+		state->evaluatedPose[1].spatialPose = evaluatedPrev;
+		memcpy(evaluatedPrev, state->samplePose->spatialPose, sizeof(a3_SpatialPose) * count);
+
+		// throttled states display the interpolated pose
+		if (state->updateInterval > a3real_zero)
+			a3hierarchyStateInternalInterpolate(state, count);
+		else
+			a3hierarchyStateMarkDirtyAll(state);
+		return count;
+	}
+	return -1;
+}
 
 
 //-----------------------------------------------------------------------------
@@ -24,9 +24,664 @@
 
 #include "../a3_HierarchyStateBlend.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef A3_SPATIALPOSE_SSE
+#include <xmmintrin.h>
+#endif	// A3_SPATIALPOSE_SSE
+
+
+//-----------------------------------------------------------------------------
+
+// fill mask
+a3i32 a3hierarchyMaskFill(a3real *mask_out, const a3ui32 nodeCount, const a3real weight)
+{
+	if (mask_out)
+	{
+		a3ui32 i;
+		for (i = 0; i < nodeCount; ++i)
+			mask_out[i] = weight;
+		return nodeCount;
+	}
+	return -1;
+}
+
+// set mask for branch; parents come before children, so walking up from 
+//	each later node stops as soon as it reaches or passes the branch root
+a3i32 a3hierarchyMaskSetBranch(a3real *mask_out, const a3_Hierarchy *hierarchy, const a3ui32 rootIndex, const a3real weight)
+{
+	if (mask_out && hierarchy && hierarchy->parentIndex && rootIndex < hierarchy->numNodes)
+	{
+		const a3i16 *parentIndex = hierarchy->parentIndex;
+		a3i32 i, j, count = 1;
+		mask_out[rootIndex] = weight;
+		for (i = rootIndex + 1; i < (a3i32)hierarchy->numNodes; ++i)
+		{
+			for (j = parentIndex[i]; j > (a3i32)rootIndex; j = parentIndex[j]);
+			if (j == (a3i32)rootIndex)
+			{
+				mask_out[i] = weight;
+				++count;
+			}
+		}
+		return count;
+	}
+	return -1;
+}
+
 
 //-----------------------------------------------------------------------------
 
+// number of inputs and parameters used by each operation
+static const a3ubyte a3blendTreeInternalInputCount[a3blendTreeOp_count] = { 0, 0, 2, 2, 1, 1, 4, 3, 2, 3 };
+static const a3ubyte a3blendTreeInternalParamCount[a3blendTreeOp_count] = { 0, 1, 1, 0, 0, 1, 2, 2, 1, 1 };
+
+
+// compiler state
+typedef struct a3_BlendTreeCompiler
+{
+	const a3_BlendTreeNode *nodes;
+	const a3real *const *masks;
+	a3_BlendTreeInstruction *instruction;
+	a3ubyte *visited;
+	a3ui32 nodeCount, instructionCount, paramCount, poseCount, maskCount;
+	a3ui32 slotUsed, slotCount;
+} a3_BlendTreeCompiler;
+
+// take the lowest free scratch slot
+inline a3i32 a3blendTreeInternalSlotAcquire(a3_BlendTreeCompiler *compiler)
+{
+	a3ui32 i;
+	for (i = 0; i < a3blendTree_slotMax; ++i)
+		if (!(compiler->slotUsed & (1u << i)))
+		{
+			compiler->slotUsed |= (1u << i);
+			compiler->slotCount = a3maximum(compiler->slotCount, i + 1);
+			return i;
+		}
+	return -1;
+}
+
+// return a scratch slot
+inline void a3blendTreeInternalSlotRelease(a3_BlendTreeCompiler *compiler, const a3ui32 slot)
+{
+	compiler->slotUsed &= ~(1u << slot);
+}
+
+// compile a node after its inputs (post-order), returns its result slot; 
+//	the output slot is taken before inputs are released, so no instruction 
+//	writes a slot it also reads
+static a3i32 a3blendTreeInternalCompileNode(a3_BlendTreeCompiler *compiler, const a3ui32 nodeIndex)
+{
+	const a3_BlendTreeNode *node;
+	a3_BlendTreeInstruction instruction = { 0 };
+	a3i32 slot[a3blendTree_inputMax], source[a3blendTree_inputMax], out;
+	a3ui32 i, inputCount;
+
+	// each node feeds one consumer only
+	if (nodeIndex >= compiler->nodeCount || compiler->visited[nodeIndex])
+		return -1;
+	compiler->visited[nodeIndex] = 1;
+	node = compiler->nodes + nodeIndex;
+	if ((a3ui32)node->op >= a3blendTreeOp_count)
+		return -1;
+	inputCount = a3blendTreeInternalInputCount[node->op];
+	for (i = 0; i < a3blendTreeInternalParamCount[node->op]; ++i)
+		if (node->param[i] >= compiler->paramCount)
+			return -1;
+	if (node->op == a3blendTreeOp_sample && 
+		(node->sample[0] >= compiler->poseCount || node->sample[1] >= compiler->poseCount))
+		return -1;
+	if ((node->op == a3blendTreeOp_override || node->op == a3blendTreeOp_additive) && 
+		node->mask > compiler->maskCount)
+		return -1;
+
+	// inputs first
+	for (i = 0; i < inputCount; ++i)
+	{
+		if (node->input[i] < 0 || (slot[i] = a3blendTreeInternalCompileNode(compiler, node->input[i])) < 0)
+			return -1;
+		source[i] = compiler->instructionCount - 1;
+	}
+
+	// samplers keep a temporary for decoding the second key pose
+	if (node->op == a3blendTreeOp_sample)
+	{
+		if ((slot[0] = a3blendTreeInternalSlotAcquire(compiler)) < 0)
+			return -1;
+		inputCount = 1;
+	}
+
+	// emit
+	if ((out = a3blendTreeInternalSlotAcquire(compiler)) < 0)
+		return -1;
+	instruction.op = (a3ui16)node->op;
+	instruction.out = (a3ui16)out;
+	for (i = 0; i < inputCount; ++i)
+	{
+		instruction.in[i] = (a3ui16)slot[i];
+		a3blendTreeInternalSlotRelease(compiler, slot[i]);
+	}
+	for (i = 0; i < a3blendTreeInternalInputCount[node->op]; ++i)
+		instruction.source[i] = (a3ui16)source[i];
+	instruction.param[0] = (a3ui16)node->param[0];
+	instruction.param[1] = (a3ui16)node->param[1];
+	instruction.sample[0] = node->sample[0];
+	instruction.sample[1] = node->sample[1];
+	if ((node->op == a3blendTreeOp_override || node->op == a3blendTreeOp_additive) && node->mask)
+		instruction.mask = compiler->masks[node->mask - 1];
+	compiler->instruction[compiler->instructionCount++] = instruction;
+	return out;
+}
+
+
+// compile blend tree
+a3i32 a3blendTreeCreate(a3_BlendTree *tree_out, const a3_HierarchyPoseGroup *poseGroup, const a3_BlendTreeNode *nodes, const a3ui32 nodeCount, const a3ui32 rootIndex, const a3ui32 paramCount, const a3real *const masks_opt[], const a3ui32 maskCount)
+{
+	if (tree_out && !tree_out->instruction && poseGroup && poseGroup->hierarchy && 
+		nodes && nodeCount && rootIndex < nodeCount && paramCount <= 0xffff && (masks_opt || !maskCount))
+	{
+		// one instruction per node at most, then visited flags (one malloc)
+		a3_BlendTreeCompiler compiler = { 0 };
+		a3i32 result;
+		compiler.instruction = (a3_BlendTreeInstruction *)malloc((sizeof(a3_BlendTreeInstruction) + sizeof(a3ubyte)) * nodeCount);
+		compiler.visited = (a3ubyte *)(compiler.instruction + nodeCount);
+		compiler.nodes = nodes;
+		compiler.nodeCount = nodeCount;
+		compiler.paramCount = paramCount;
+		compiler.poseCount = poseGroup->hposeCount;
+		compiler.masks = masks_opt;
+		compiler.maskCount = maskCount;
+		memset(compiler.visited, 0, nodeCount);
+
+		result = a3blendTreeInternalCompileNode(&compiler, rootIndex);
+		if (result < 0)
+		{
+			free(compiler.instruction);
+			return -1;
+		}
+
+		tree_out->poseGroup = poseGroup;
+		tree_out->instruction = compiler.instruction;
+		tree_out->instructionCount = compiler.instructionCount;
+		tree_out->slotCount = compiler.slotCount;
+		tree_out->resultSlot = result;
+		tree_out->paramCount = paramCount;
+		tree_out->cullEpsilon = (a3real)0.001;
+		return compiler.instructionCount;
+	}
+	return -1;
+}
+
+// release blend tree
+a3i32 a3blendTreeRelease(a3_BlendTree *tree)
+{
+	if (tree && tree->instruction)
+	{
+		free(tree->instruction);
+		tree->poseGroup = 0;
+		tree->instruction = 0;
+		tree->instructionCount = tree->slotCount = tree->resultSlot = tree->paramCount = 0;
+		tree->cullEpsilon = a3real_zero;
+		return 1;
+	}
+	return -1;
+}
+
+
+// allocate scratch arena
+a3i32 a3blendTreeScratchCreate(a3_BlendTreeScratch *scratch_out, const a3_BlendTree *tree, const a3ui32 instanceCount)
+{
+	if (scratch_out && !scratch_out->slot && tree && tree->instruction && instanceCount)
+	{
+		// slot headers, then poses, then weights (one malloc)
+		const a3ui32 slotCount = tree->slotCount * instanceCount, nodeCount = tree->poseGroup->hierarchy->numNodes;
+		a3_SpatialPose *pose;
+		a3ui32 i;
+		scratch_out->slot = (a3_HierarchyPose *)malloc(sizeof(a3_HierarchyPose) * slotCount + sizeof(a3_SpatialPose) * slotCount * nodeCount + 
+			sizeof(a3real) * tree->instructionCount * instanceCount);
+		pose = (a3_SpatialPose *)(scratch_out->slot + slotCount);
+		for (i = 0; i < slotCount; ++i)
+			scratch_out->slot[i].spatialPose = pose + i * nodeCount;
+		scratch_out->weight = (a3real *)(pose + slotCount * nodeCount);
+		scratch_out->slotCount = tree->slotCount;
+		scratch_out->instructionCount = tree->instructionCount;
+		scratch_out->instanceCount = instanceCount;
+		scratch_out->nodeCount = nodeCount;
+		scratch_out->executeCount = scratch_out->cullCount = scratch_out->sampleSkipCount = scratch_out->copyCount = 0;
+		return slotCount;
+	}
+	return -1;
+}
+
+// release scratch arena
+a3i32 a3blendTreeScratchRelease(a3_BlendTreeScratch *scratch)
+{
+	if (scratch && scratch->slot)
+	{
+		free(scratch->slot);
+		scratch->slot = 0;
+		scratch->weight = 0;
+		scratch->slotCount = scratch->instructionCount = scratch->instanceCount = scratch->nodeCount = 0;
+		return 1;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// pruning of a two-way blend given its effective weight: 0 blends both 
+//	sides, 1 keeps only the first (base, or identity when scaling), 2 keeps 
+//	only the second; masked and additive layers always keep the base
+inline a3ui32 a3blendTreeInternalMode(const a3_BlendTreeInstruction *instruction, const a3real *param, const a3real w, const a3real eps)
+{
+	const a3real u = param[instruction->param[0]];
+	if (a3absolute(w * u) < eps)
+		return 1;
+	if (a3absolute(w * (a3real_one - u)) < eps && !instruction->mask && instruction->op != a3blendTreeOp_additive)
+		return 2;
+	return 0;
+}
+
+// input weights of a bilerp or triangular blend; inputs whose effective 
+//	weight is below epsilon are dropped and the rest renormalized, always 
+//	keeping the heaviest; returns one bit per kept input
+inline a3ui32 a3blendTreeInternalSumWeights(a3real weight_out[4], const a3_BlendTreeInstruction *instruction, const a3real *param, const a3real w, const a3real eps)
+{
+	const a3real u0 = param[instruction->param[0]], u1 = param[instruction->param[1]];
+	a3real sum = a3real_zero;
+	a3ui32 k, count, kept = 0, heaviest = 0;
+	if (instruction->op == a3blendTreeOp_bilerp)
+	{
+		weight_out[0] = (a3real_one - u0) * (a3real_one - u1);
+		weight_out[1] = u0 * (a3real_one - u1);
+		weight_out[2] = (a3real_one - u0) * u1;
+		weight_out[3] = u0 * u1;
+		count = 4;
+	}
+	else
+	{
+		weight_out[0] = a3real_one - u0 - u1;
+		weight_out[1] = u0;
+		weight_out[2] = u1;
+		weight_out[3] = a3real_zero;
+		count = 3;
+	}
+	for (k = 0; k < count; ++k)
+	{
+		if (weight_out[k] > weight_out[heaviest])
+			heaviest = k;
+		if (a3absolute(w * weight_out[k]) >= eps)
+		{
+			kept |= (1u << k);
+			sum += weight_out[k];
+		}
+	}
+	if (!kept)
+	{
+		kept = (1u << heaviest);
+		sum = weight_out[heaviest];
+	}
+	if (kept != (1u << count) - 1)
+		for (k = 0, sum = a3recip(sum); k < 4; ++k)
+			weight_out[k] = (kept & (1u << k)) ? weight_out[k] * sum : a3real_zero;
+	return kept;
+}
+
+// effective weight of every instruction for one instance, from the root 
+//	back to the leaves; only the magnitude is kept, since extrapolated 
+//	blends give inputs negative weights, and inputs that a kept instruction 
+//	drops are never reached and stay culled (negative)
+inline void a3blendTreeInternalWeigh(a3real *weight, const a3_BlendTree *tree, const a3real *param)
+{
+	const a3real eps = tree->cullEpsilon;
+	const a3_BlendTreeInstruction *instruction;
+	const a3ui16 *source;
+	a3real w, u, sum[4];
+	a3ui32 j, k, kept;
+	for (j = 0; j < tree->instructionCount; ++j)
+		weight[j] = -a3real_one;
+	weight[tree->instructionCount - 1] = a3real_one;
+	for (j = tree->instructionCount; j-- > 0; )
+	{
+		if ((w = weight[j]) < a3real_zero)
+			continue;
+		instruction = tree->instruction + j;
+		source = instruction->source;
+		switch (instruction->op)
+		{
+		case a3blendTreeOp_lerp:
+		case a3blendTreeOp_override:
+			u = param[instruction->param[0]];
+			switch (a3blendTreeInternalMode(instruction, param, w, eps))
+			{
+			case 0:
+				weight[source[0]] = instruction->mask ? w : a3absolute(w * (a3real_one - u));
+				weight[source[1]] = a3absolute(w * u);
+				break;
+			case 1:
+				weight[source[0]] = w;
+				break;
+			case 2:
+				weight[source[1]] = w;
+				break;
+			}
+			break;
+		case a3blendTreeOp_concat:
+			weight[source[0]] = weight[source[1]] = w;
+			break;
+		case a3blendTreeOp_negate:
+			weight[source[0]] = w;
+			break;
+		case a3blendTreeOp_scale:
+			u = param[instruction->param[0]];
+			switch (a3blendTreeInternalMode(instruction, param, w, eps))
+			{
+			case 0:
+				weight[source[0]] = a3absolute(w * u);
+				break;
+			case 2:
+				weight[source[0]] = w;
+				break;
+			}
+			break;
+		case a3blendTreeOp_bilerp:
+		case a3blendTreeOp_triangular:
+			kept = a3blendTreeInternalSumWeights(sum, instruction, param, w, eps);
+			for (k = 0; k < a3blendTree_inputMax; ++k)
+				if (kept & (1u << k))
+					weight[source[k]] = a3absolute(w * sum[k]);
+			break;
+		case a3blendTreeOp_additive:
+			weight[source[0]] = w;
+			if (!a3blendTreeInternalMode(instruction, param, w, eps))
+				weight[source[1]] = weight[source[2]] = a3absolute(w * param[instruction->param[0]]);
+			break;
+		}
+	}
+}
+
+
+// copy one key pose from pose group
+inline void a3blendTreeInternalSampleKey(const a3_HierarchyPose *pose_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 sample, const a3ui32 nodeCount)
+{
+	if (poseGroup->compactPosePool)
+		a3hierarchyPoseGroupGetPose(pose_out, poseGroup, sample);
+	else
+		a3hierarchyPoseOpCopy(pose_out, poseGroup->hpose + sample, nodeCount);
+}
+
+// sample key poses from pose group
+inline void a3blendTreeInternalSample(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *temp, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 sample0, const a3ui32 sample1, const a3ui32 nodeCount, const a3real u)
+{
+	if (poseGroup->compactPosePool)
+	{
+		a3hierarchyPoseGroupGetPose(pose_out, poseGroup, sample0);
+		a3hierarchyPoseGroupGetPose(temp, poseGroup, sample1);
+		a3hierarchyPoseOpLerp(pose_out, pose_out, temp, nodeCount, u);
+	}
+	else
+		a3hierarchyPoseOpLerp(pose_out, poseGroup->hpose + sample0, poseGroup->hpose + sample1, nodeCount, u);
+}
+
+// weighted sum of the kept inputs of a pruned bilerp or triangular blend; 
+//	dropped inputs are never read
+inline void a3blendTreeInternalSumKept(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *slot, const a3ui32 stride, const a3ui16 in[4], const a3real weight[4], const a3ui32 kept, const a3ui32 nodeCount)
+{
+	const a3_SpatialPose *p[4];
+	a3_SpatialPose *out = pose_out->spatialPose;
+	a3ui32 i, k, first = 0;
+	while (!(kept & (1u << first)))
+		++first;
+	for (k = 0; k < 4; ++k)
+		p[k] = slot[in[(kept & (1u << k)) ? k : first] * stride].spatialPose;
+	for (i = 0; i < nodeCount; ++i)
+		a3spatialPoseInternalSum(out + i, p[0] + i, p[1] + i, p[2] + i, p[3] + i, weight[0], weight[1], weight[2], weight[3]);
+}
+
+// execute one instruction for one instance with effective weight w; slots 
+//	of the instance are stride apart; returns 1 if a blend was replaced by 
+//	a copy
+inline a3ui32 a3blendTreeInternalExecute(const a3_BlendTreeInstruction *instruction, const a3_HierarchyPose *slot, const a3ui32 stride, const a3_HierarchyPoseGroup *poseGroup, const a3real *param, const a3ui32 nodeCount, const a3real w, const a3real eps)
+{
+	const a3_HierarchyPose *out = slot + instruction->out * stride;
+	const a3ui16 *in = instruction->in;
+	a3real sum[4];
+	a3ui32 mode, kept;
+	switch (instruction->op)
+	{
+	case a3blendTreeOp_identity:
+		a3hierarchyPoseOpIdentity(out, nodeCount);
+		break;
+	case a3blendTreeOp_sample:
+		if ((mode = a3blendTreeInternalMode(instruction, param, w, eps)))
+		{
+			a3blendTreeInternalSampleKey(out, poseGroup, instruction->sample[mode - 1], nodeCount);
+			return 1;
+		}
+		a3blendTreeInternalSample(out, slot + in[0] * stride, poseGroup, instruction->sample[0], instruction->sample[1], nodeCount, param[instruction->param[0]]);
+		break;
+	case a3blendTreeOp_lerp:
+	case a3blendTreeOp_override:
+		if ((mode = a3blendTreeInternalMode(instruction, param, w, eps)))
+		{
+			a3hierarchyPoseOpCopy(out, slot + in[mode - 1] * stride, nodeCount);
+			return 1;
+		}
+		if (instruction->op == a3blendTreeOp_lerp)
+			a3hierarchyPoseOpLerp(out, slot + in[0] * stride, slot + in[1] * stride, nodeCount, param[instruction->param[0]]);
+		else
+			a3hierarchyPoseOpOverride(out, slot + in[0] * stride, slot + in[1] * stride, nodeCount, param[instruction->param[0]], instruction->mask);
+		break;
+	case a3blendTreeOp_concat:
+		a3hierarchyPoseOpConcat(out, slot + in[0] * stride, slot + in[1] * stride, nodeCount);
+		break;
+	case a3blendTreeOp_negate:
+		a3hierarchyPoseOpNegate(out, slot + in[0] * stride, nodeCount);
+		break;
+	case a3blendTreeOp_scale:
+		switch (a3blendTreeInternalMode(instruction, param, w, eps))
+		{
+		case 1:
+			a3hierarchyPoseOpIdentity(out, nodeCount);
+			return 1;
+		case 2:
+			a3hierarchyPoseOpCopy(out, slot + in[0] * stride, nodeCount);
+			return 1;
+		}
+		a3hierarchyPoseOpScale(out, slot + in[0] * stride, nodeCount, param[instruction->param[0]]);
+		break;
+	case a3blendTreeOp_bilerp:
+	case a3blendTreeOp_triangular:
+		kept = a3blendTreeInternalSumWeights(sum, instruction, param, w, eps);
+		if (kept == (instruction->op == a3blendTreeOp_bilerp ? 0xfu : 0x7u))
+		{
+			if (instruction->op == a3blendTreeOp_bilerp)
+				a3hierarchyPoseOpBilerp(out, slot + in[0] * stride, slot + in[1] * stride, slot + in[2] * stride, slot + in[3] * stride, nodeCount, param[instruction->param[0]], param[instruction->param[1]]);
+			else
+				a3hierarchyPoseOpTriangular(out, slot + in[0] * stride, slot + in[1] * stride, slot + in[2] * stride, nodeCount, param[instruction->param[0]], param[instruction->param[1]]);
+		}
+		else if (!(kept & (kept - 1)))
+		{
+			for (mode = 0; !(kept & (1u << mode)); ++mode);
+			a3hierarchyPoseOpCopy(out, slot + in[mode] * stride, nodeCount);
+			return 1;
+		}
+		else
+			a3blendTreeInternalSumKept(out, slot, stride, in, sum, kept, nodeCount);
+		break;
+	case a3blendTreeOp_additive:
+		if (a3blendTreeInternalMode(instruction, param, w, eps))
+		{
+			a3hierarchyPoseOpCopy(out, slot + in[0] * stride, nodeCount);
+			return 1;
+		}
+		a3hierarchyPoseOpAdditive(out, slot + in[0] * stride, slot + in[1] * stride, slot + in[2] * stride, nodeCount, param[instruction->param[0]], instruction->mask);
+		break;
+	}
+	return 0;
+}
+
+
+#ifdef A3_SPATIALPOSE_SSE
+// lerp 4 hierarchy poses at once, one instance per lane; orientations are 
+//	transposed so each lane runs the scalar nlerp with the same operation 
+//	order and the same square root and divide (see 
+//	a3spatialPoseInternalSqrtInverse), giving the same result as the 
+//	scalar kernel
+inline void a3blendTreeInternalLerpLanes(const a3_HierarchyPose *const pose_out[4], const a3_HierarchyPose *const pose0[4], const a3_HierarchyPose *const pose1[4], const a3real u[4], const a3ui32 nodeCount)
+{
+	const __m128 u1 = _mm_loadu_ps(u), u0 = _mm_sub_ps(_mm_set1_ps(a3real_one), u1), zero = _mm_setzero_ps(), one = _mm_set1_ps(a3real_one);
+	__m128 x0, y0, z0, w0, x1, y1, z1, w1, flip, u1s, x, y, z, w, lenInv;
+	a3ui32 i, k;
+	for (i = 0; i < nodeCount; ++i)
+	{
+		x0 = _mm_loadu_ps(pose0[0]->spatialPose[i].orientation.v);
+		y0 = _mm_loadu_ps(pose0[1]->spatialPose[i].orientation.v);
+		z0 = _mm_loadu_ps(pose0[2]->spatialPose[i].orientation.v);
+		w0 = _mm_loadu_ps(pose0[3]->spatialPose[i].orientation.v);
+		x1 = _mm_loadu_ps(pose1[0]->spatialPose[i].orientation.v);
+		y1 = _mm_loadu_ps(pose1[1]->spatialPose[i].orientation.v);
+		z1 = _mm_loadu_ps(pose1[2]->spatialPose[i].orientation.v);
+		w1 = _mm_loadu_ps(pose1[3]->spatialPose[i].orientation.v);
+		_MM_TRANSPOSE4_PS(x0, y0, z0, w0);
+		_MM_TRANSPOSE4_PS(x1, y1, z1, w1);
+
+		// hemisphere check negates the second weight
+		flip = _mm_cmplt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x0, x1), _mm_mul_ps(y0, y1)), _mm_mul_ps(z0, z1)), _mm_mul_ps(w0, w1)), zero);
+		u1s = _mm_or_ps(_mm_and_ps(flip, _mm_sub_ps(zero, u1)), _mm_andnot_ps(flip, u1));
+		x = _mm_add_ps(_mm_mul_ps(x0, u0), _mm_mul_ps(x1, u1s));
+		y = _mm_add_ps(_mm_mul_ps(y0, u0), _mm_mul_ps(y1, u1s));
+		z = _mm_add_ps(_mm_mul_ps(z0, u0), _mm_mul_ps(z1, u1s));
+		w = _mm_add_ps(_mm_mul_ps(w0, u0), _mm_mul_ps(w1, u1s));
+		lenInv = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)), _mm_mul_ps(w, w))));
+		x = _mm_mul_ps(x, lenInv);
+		y = _mm_mul_ps(y, lenInv);
+		z = _mm_mul_ps(z, lenInv);
+		w = _mm_mul_ps(w, lenInv);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		_mm_storeu_ps(pose_out[0]->spatialPose[i].orientation.v, x);
+		_mm_storeu_ps(pose_out[1]->spatialPose[i].orientation.v, y);
+		_mm_storeu_ps(pose_out[2]->spatialPose[i].orientation.v, z);
+		_mm_storeu_ps(pose_out[3]->spatialPose[i].orientation.v, w);
+
+		// vectors stay per lane
+		for (k = 0; k < 4; ++k)
+		{
+			a3spatialPoseInternalLerpVec3(&pose_out[k]->spatialPose[i].scale, &pose0[k]->spatialPose[i].scale, &pose1[k]->spatialPose[i].scale, u[k]);
+			a3spatialPoseInternalLerpVec3(&pose_out[k]->spatialPose[i].translation, &pose0[k]->spatialPose[i].translation, &pose1[k]->spatialPose[i].translation, u[k]);
+		}
+	}
+}
+
+// execute a lerp, unmasked override or uncompressed sample for 4 adjacent 
+//	instances, only if none of them is culled or pruned to a copy
+inline a3boolean a3blendTreeInternalExecuteLanes(const a3_BlendTreeInstruction *instruction, const a3_HierarchyPose *slot, const a3ui32 stride, const a3_HierarchyPoseGroup *poseGroup, const a3real *param, const a3ui32 paramCount, const a3real *weight, const a3ui32 weightCount, const a3real eps, const a3ui32 nodeCount)
+{
+	const a3_HierarchyPose *out[4], *in0[4], *in1[4];
+	a3real u[4];
+	a3ui32 k;
+	switch (instruction->op)
+	{
+	case a3blendTreeOp_sample:
+		if (poseGroup->compactPosePool)
+			return false;
+		for (k = 0; k < 4; ++k)
+		{
+			in0[k] = poseGroup->hpose + instruction->sample[0];
+			in1[k] = poseGroup->hpose + instruction->sample[1];
+		}
+		break;
+	case a3blendTreeOp_override:
+		// unmasked override is a lerp
+		if (instruction->mask)
+			return false;
+		// fall through
+	case a3blendTreeOp_lerp:
+		for (k = 0; k < 4; ++k)
+		{
+			in0[k] = slot + instruction->in[0] * stride + k;
+			in1[k] = slot + instruction->in[1] * stride + k;
+		}
+		break;
+	default:
+		return false;
+	}
+	for (k = 0; k < 4; ++k)
+	{
+		if (weight[k * weightCount] < a3real_zero || 
+			a3blendTreeInternalMode(instruction, param + k * paramCount, weight[k * weightCount], eps))
+			return false;
+		out[k] = slot + instruction->out * stride + k;
+		u[k] = param[k * paramCount + instruction->param[0]];
+	}
+	a3blendTreeInternalLerpLanes(out, in0, in1, u, nodeCount);
+	return true;
+}
+#endif	// A3_SPATIALPOSE_SSE
+
+
+// evaluate blend tree
+a3i32 a3blendTreeEvaluate(const a3_HierarchyPose *pose_out, const a3_BlendTree *tree, a3_BlendTreeScratch *scratch, const a3real *param, const a3ui32 nodeCount)
+{
+	return a3blendTreeEvaluateMany(pose_out, tree, scratch, param, 1, nodeCount);
+}
+
+// evaluate many instances
+a3i32 a3blendTreeEvaluateMany(const a3_HierarchyPose poses_out[], const a3_BlendTree *tree, a3_BlendTreeScratch *scratch, const a3real *param, const a3ui32 instanceCount, const a3ui32 nodeCount)
+{
+	if (poses_out && tree && tree->instruction && scratch && scratch->slot && 
+		scratch->slotCount >= tree->slotCount && scratch->instructionCount >= tree->instructionCount && 
+		instanceCount && instanceCount <= scratch->instanceCount && nodeCount <= scratch->nodeCount && (param || !tree->paramCount))
+	{
+		const a3_HierarchyPose *slot = scratch->slot;
+		const a3_BlendTreeInstruction *instruction = tree->instruction;
+		const a3ui32 stride = scratch->instanceCount, paramCount = tree->paramCount, instructionCount = tree->instructionCount;
+		const a3real eps = tree->cullEpsilon;
+		a3real *weight = scratch->weight, w;
+		a3ui32 j, k;
+
+		// weigh each instance first so culled branches are known up front
+		scratch->executeCount = scratch->cullCount = scratch->sampleSkipCount = scratch->copyCount = 0;
+		for (k = 0; k < instanceCount; ++k)
+			a3blendTreeInternalWeigh(weight + k * instructionCount, tree, param + k * paramCount);
+
+		// straight interpreter loop, instances innermost
+		for (j = 0; j < instructionCount; ++j, ++instruction)
+		{
+			for (k = 0; k < instanceCount; )
+			{
+#ifdef A3_SPATIALPOSE_SSE
+				if (k + 4 <= instanceCount && 
+					a3blendTreeInternalExecuteLanes(instruction, slot + k, stride, tree->poseGroup, param + k * paramCount, paramCount, weight + k * instructionCount + j, instructionCount, eps, nodeCount))
+				{
+					scratch->executeCount += 4;
+					k += 4;
+					continue;
+				}
+#endif	// A3_SPATIALPOSE_SSE
+				w = weight[k * instructionCount + j];
+				if (w >= a3real_zero)
+				{
+					scratch->copyCount += a3blendTreeInternalExecute(instruction, slot + k, stride, tree->poseGroup, param + k * paramCount, nodeCount, w, eps);
+					++scratch->executeCount;
+				}
+				else
+				{
+					scratch->sampleSkipCount += (instruction->op == a3blendTreeOp_sample);
+					++scratch->cullCount;
+				}
+				++k;
+			}
+		}
+		for (k = 0; k < instanceCount; ++k)
+			a3hierarchyPoseOpCopy(poses_out + k, slot + tree->resultSlot * stride + k, nodeCount);
+		return scratch->executeCount;
+	}
+	return -1;
+}
 
 
 //-----------------------------------------------------------------------------
@@ -24,6 +24,63 @@
 
 #include "../a3_Kinematics.h"
 
+#include "animal3D/a3utility/a3_Timer.h"
+
+#include <stdlib.h>
+
+#ifdef A3_SPATIALPOSE_SSE
+#include <xmmintrin.h>
+#endif	// A3_SPATIALPOSE_SSE
+
+
+//-----------------------------------------------------------------------------
+
+// affine product, scalar reference: only the upper 3 rows are multiplied, 
+//	the bottom row of both inputs is known to be [0 0 0 1]
+inline void a3kinematicsInternalProductAffineScalar(a3mat4 *m_out, const a3mat4 *mL, const a3mat4 *mR)
+{
+	m_out->m00 = mL->m00 * mR->m00 + mL->m10 * mR->m01 + mL->m20 * mR->m02;
+	m_out->m01 = mL->m01 * mR->m00 + mL->m11 * mR->m01 + mL->m21 * mR->m02;
+	m_out->m02 = mL->m02 * mR->m00 + mL->m12 * mR->m01 + mL->m22 * mR->m02;
+	m_out->m10 = mL->m00 * mR->m10 + mL->m10 * mR->m11 + mL->m20 * mR->m12;
+	m_out->m11 = mL->m01 * mR->m10 + mL->m11 * mR->m11 + mL->m21 * mR->m12;
+	m_out->m12 = mL->m02 * mR->m10 + mL->m12 * mR->m11 + mL->m22 * mR->m12;
+	m_out->m20 = mL->m00 * mR->m20 + mL->m10 * mR->m21 + mL->m20 * mR->m22;
+	m_out->m21 = mL->m01 * mR->m20 + mL->m11 * mR->m21 + mL->m21 * mR->m22;
+	m_out->m22 = mL->m02 * mR->m20 + mL->m12 * mR->m21 + mL->m22 * mR->m22;
+	m_out->m30 = mL->m00 * mR->m30 + mL->m10 * mR->m31 + mL->m20 * mR->m32 + mL->m30;
+	m_out->m31 = mL->m01 * mR->m30 + mL->m11 * mR->m31 + mL->m21 * mR->m32 + mL->m31;
+	m_out->m32 = mL->m02 * mR->m30 + mL->m12 * mR->m31 + mL->m22 * mR->m32 + mL->m32;
+	m_out->m03 = m_out->m13 = m_out->m23 = a3real_zero;
+	m_out->m33 = a3real_one;
+}
+
+// affine product
+inline void a3kinematicsInternalProductAffine(a3mat4 *m_out, const a3mat4 *mL, const a3mat4 *mR)
+{
+#ifdef A3_SPATIALPOSE_SSE
+	// each result column is a combination of the left columns weighted by 
+	//	one right column; the left bottom row is [0 0 0 1], so the result 
+	//	bottom row comes out as [0 0 0 1] as well, and only the translation 
+	//	column needs the left translation added
+	const __m128 c0 = _mm_loadu_ps(mL->v[0].v), c1 = _mm_loadu_ps(mL->v[1].v), c2 = _mm_loadu_ps(mL->v[2].v), c3 = _mm_loadu_ps(mL->v[3].v);
+	const a3real *r;
+	__m128 sum;
+	a3ui32 i;
+	for (i = 0; i < 4; ++i)
+	{
+		// same summation order as the scalar reference
+		r = mR->v[i].v;
+		sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(r[0])), _mm_mul_ps(c1, _mm_set1_ps(r[1]))), _mm_mul_ps(c2, _mm_set1_ps(r[2])));
+		if (i == 3)
+			sum = _mm_add_ps(sum, c3);
+		_mm_storeu_ps(m_out->v[i].v, sum);
+	}
+#else	// !A3_SPATIALPOSE_SSE
+	a3kinematicsInternalProductAffineScalar(m_out, mL, mR);
+#endif	// A3_SPATIALPOSE_SSE
+}
+
 
 //-----------------------------------------------------------------------------
 
@@ -33,12 +90,261 @@ a3i32 a3kinematicsSolveForwardPartial(const a3_HierarchyState *hierarchyState, c
 	if (hierarchyState && hierarchyState->poseGroup && 
 		firstIndex < hierarchyState->poseGroup->hierarchy->numNodes && nodeCount)
 	{
-		// ****TO-DO: implement forward kinematics algorithm
-		//	- for all nodes starting at first index
+		const a3_Hierarchy *hierarchy = hierarchyState->poseGroup->hierarchy;
+		const a3i16 *parentIndex = hierarchy->parentIndex;
+		const a3mat4 *localSpace = hierarchyState->localSpace->transform;
+		a3mat4 *objectSpace = hierarchyState->objectSpace->transform;
+		a3ubyte *dirty = hierarchyState->nodeDirty;
+		const a3ui32 lastIndex = a3minimum(firstIndex + nodeCount, hierarchy->lodNodeCount[hierarchyState->lod]);
+		a3ui32 i, updated = 0;
+		a3i32 j;
+
+		//	- for all dirty nodes starting at first index, up to the last 
+		//		node evaluated at the current detail level
 		//		- if node is not root (has parent node)
 		//			- object matrix = parent object matrix * local matrix
 		//		- else
 		//			- copy local matrix to object matrix
+		for (i = firstIndex; i < lastIndex; ++i)
+		{
+			if (dirty[i] & a3hierarchyStateDirty_object)
+			{
+				j = parentIndex[i];
+				if (j >= 0)
+				{
+					a3kinematicsInternalProductAffine(objectSpace + i, objectSpace + j, localSpace + i);
+
+					// a parent outside the range may still be out of date, 
+					//	in which case this node stays dirty
+					if (!(dirty[j] & a3hierarchyStateDirty_object))
+						dirty[i] &= ~a3hierarchyStateDirty_object;
+				}
+				else
+				{
+					objectSpace[i] = localSpace[i];
+					dirty[i] &= ~a3hierarchyStateDirty_object;
+				}
+				++updated;
+			}
+		}
+		return updated;
+	}
+	return -1;
+}
+
+
+#ifdef A3_SPATIALPOSE_SSE
+// affine product for 4 states at once, one state per lane: matrices are 
+//	transposed so each register holds one element across all 4 states; 
+//	same summation order as the scalar reference
+inline void a3kinematicsInternalProductAffineLanes(a3mat4 *const m_out[4], const a3mat4 *const mL[4], const a3mat4 *const mR[4])
+{
+	__m128 l[4][4], r[4][4], o[4][4], sum;
+	a3ui32 c, k;
+
+	// load and transpose: l[c][k] = column c, row k of each lane
+	for (c = 0; c < 4; ++c)
+	{
+		l[c][0] = _mm_loadu_ps(mL[0]->v[c].v);
+		l[c][1] = _mm_loadu_ps(mL[1]->v[c].v);
+		l[c][2] = _mm_loadu_ps(mL[2]->v[c].v);
+		l[c][3] = _mm_loadu_ps(mL[3]->v[c].v);
+		_MM_TRANSPOSE4_PS(l[c][0], l[c][1], l[c][2], l[c][3]);
+		r[c][0] = _mm_loadu_ps(mR[0]->v[c].v);
+		r[c][1] = _mm_loadu_ps(mR[1]->v[c].v);
+		r[c][2] = _mm_loadu_ps(mR[2]->v[c].v);
+		r[c][3] = _mm_loadu_ps(mR[3]->v[c].v);
+		_MM_TRANSPOSE4_PS(r[c][0], r[c][1], r[c][2], r[c][3]);
+	}
+
+	// upper 3 rows of each result column
+	for (c = 0; c < 4; ++c)
+	{
+		for (k = 0; k < 3; ++k)
+		{
+			sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l[0][k], r[c][0]), _mm_mul_ps(l[1][k], r[c][1])), _mm_mul_ps(l[2][k], r[c][2]));
+			o[c][k] = c == 3 ? _mm_add_ps(sum, l[3][k]) : sum;
+		}
+		o[c][3] = c == 3 ? _mm_set1_ps(a3real_one) : _mm_setzero_ps();
+	}
+
+	// transpose back and store
+	for (c = 0; c < 4; ++c)
+	{
+		_MM_TRANSPOSE4_PS(o[c][0], o[c][1], o[c][2], o[c][3]);
+		for (k = 0; k < 4; ++k)
+			if (m_out[k])
+				_mm_storeu_ps(m_out[k]->v[c].v, o[c][k]);
+	}
+}
+#endif	// A3_SPATIALPOSE_SSE
+
+
+// multi-state FK solver
+a3i32 a3kinematicsSolveForwardMany(const a3_HierarchyState *const hierarchyStates[], const a3ui32 stateCount)
+{
+	if (hierarchyStates)
+	{
+		const a3_HierarchyState *state;
+		a3i32 updated = 0, result;
+		a3ui32 n = 0;
+
+#ifdef A3_SPATIALPOSE_SSE
+		const a3_HierarchyState *lane[4];
+		const a3_Hierarchy *hierarchy;
+		const a3mat4 *parent[4], *local[4];
+		a3mat4 *object[4];
+		a3ui32 count[4], countMax, i, k;
+		a3i32 j;
+
+		// groups of 4 consecutive states sharing a hierarchy
+		for (; n + 4 <= stateCount; n += 4)
+		{
+			for (k = 0; k < 4; ++k)
+			{
+				lane[k] = hierarchyStates[n + k];
+				if (!lane[k] || !lane[k]->poseGroup || lane[k]->poseGroup->hierarchy != lane[0]->poseGroup->hierarchy)
+					break;
+			}
+			if (k < 4)
+			{
+				// mixed group, solve each individually
+				for (k = 0; k < 4; ++k)
+					if ((state = hierarchyStates[n + k]) && state->poseGroup && (result = a3kinematicsSolveForward(state)) > 0)
+						updated += result;
+				continue;
+			}
+
+			hierarchy = lane[0]->poseGroup->hierarchy;
+			for (k = countMax = 0; k < 4; ++k)
+			{
+				count[k] = hierarchy->lodNodeCount[lane[k]->lod];
+				countMax = a3maximum(countMax, count[k]);
+			}
+
+			// same parent index in every lane; lanes that are clean or past 
+			//	their detail level still compute but do not store
+			for (i = 0; i < countMax; ++i)
+			{
+				j = hierarchy->parentIndex[i];
+				for (k = 0; k < 4; ++k)
+				{
+					object[k] = (i < count[k] && (lane[k]->nodeDirty[i] & a3hierarchyStateDirty_object)) ? lane[k]->objectSpace->transform + i : 0;
+					local[k] = lane[k]->localSpace->transform + i;
+					parent[k] = lane[k]->objectSpace->transform + (j >= 0 ? j : 0);
+				}
+				if (!object[0] && !object[1] && !object[2] && !object[3])
+					continue;
+				if (j >= 0)
+					a3kinematicsInternalProductAffineLanes(object, parent, local);
+				for (k = 0; k < 4; ++k)
+				{
+					if (object[k])
+					{
+						if (j < 0)
+							*object[k] = *local[k];
+						lane[k]->nodeDirty[i] &= ~a3hierarchyStateDirty_object;
+						++updated;
+					}
+				}
+			}
+		}
+#endif	// A3_SPATIALPOSE_SSE
+
+		// remaining states one at a time
+		for (; n < stateCount; ++n)
+			if ((state = hierarchyStates[n]) && state->poseGroup && (result = a3kinematicsSolveForward(state)) > 0)
+				updated += result;
+		return updated;
+	}
+	return -1;
+}
+
+
+// pose FK solver
+a3i32 a3kinematicsSolveForwardPose(const a3_HierarchyState *hierarchyState)
+{
+	if (hierarchyState && hierarchyState->poseGroup)
+	{
+		const a3_Hierarchy *hierarchy = hierarchyState->poseGroup->hierarchy;
+		const a3i16 *parentIndex = hierarchy->parentIndex;
+		const a3_SpatialPose *localPose = hierarchyState->samplePose->spatialPose, *l, *p;
+		a3_SpatialPose *objectPose = hierarchyState->objectPose->spatialPose, *o;
+		a3mat4 *objectSpace = hierarchyState->objectSpace->transform;
+		a3ubyte *dirty = hierarchyState->nodeDirty;
+		const a3ui32 count = hierarchy->lodNodeCount[hierarchyState->lod];
+		a3real tx, ty, tz, cx, cy, cz;
+		a3ui32 i, updated = 0;
+		a3i32 j;
+
+		// object poses are only written here, so they have their own dirty 
+		//	bit; matrix FK clearing the object bit does not make them current
+		for (i = 0; i < count; ++i)
+		{
+			if (!(dirty[i] & a3hierarchyStateDirty_objectPose))
+				continue;
+			j = parentIndex[i];
+			l = localPose + i;
+			o = objectPose + i;
+			if (j >= 0)
+			{
+				p = objectPose + j;
+
+				// translation: parent scale, then parent rotation, using 
+				//	v' = v + w * c + q x c, with c = 2 * (q x v)
+				tx = l->translation.x * p->scale.x;
+				ty = l->translation.y * p->scale.y;
+				tz = l->translation.z * p->scale.z;
+				cx = (p->orientation.y * tz - p->orientation.z * ty) * a3real_two;
+				cy = (p->orientation.z * tx - p->orientation.x * tz) * a3real_two;
+				cz = (p->orientation.x * ty - p->orientation.y * tx) * a3real_two;
+				o->translation.x = p->translation.x + tx + p->orientation.w * cx + (p->orientation.y * cz - p->orientation.z * cy);
+				o->translation.y = p->translation.y + ty + p->orientation.w * cy + (p->orientation.z * cx - p->orientation.x * cz);
+				o->translation.z = p->translation.z + tz + p->orientation.w * cz + (p->orientation.x * cy - p->orientation.y * cx);
+
+				// rotation and scale
+				o->orientation.x = p->orientation.w * l->orientation.x + p->orientation.x * l->orientation.w + p->orientation.y * l->orientation.z - p->orientation.z * l->orientation.y;
+				o->orientation.y = p->orientation.w * l->orientation.y - p->orientation.x * l->orientation.z + p->orientation.y * l->orientation.w + p->orientation.z * l->orientation.x;
+				o->orientation.z = p->orientation.w * l->orientation.z + p->orientation.x * l->orientation.y - p->orientation.y * l->orientation.x + p->orientation.z * l->orientation.w;
+				o->orientation.w = p->orientation.w * l->orientation.w - p->orientation.x * l->orientation.x - p->orientation.y * l->orientation.y - p->orientation.z * l->orientation.z;
+				o->scale.x = p->scale.x * l->scale.x;
+				o->scale.y = p->scale.y * l->scale.y;
+				o->scale.z = p->scale.z * l->scale.z;
+			}
+			else
+				*o = *l;
+			dirty[i] &= ~(a3hierarchyStateDirty_object | a3hierarchyStateDirty_objectPose);
+			++updated;
+
+			// one conversion per node, after its pose is final; object poses 
+			//	accumulate every ancestor's channels, so convert all of them
+			a3spatialPoseConvert(objectSpace + i, o);
+		}
+		return updated;
+	}
+	return -1;
+}
+
+// dual quaternion FK solver
+a3i32 a3kinematicsSolveForwardDQ(const a3_HierarchyPoseDQ *objectPose_out, const a3_HierarchyPoseDQ *localPose, const a3_Hierarchy *hierarchy)
+{
+	if (objectPose_out && objectPose_out->spatialPose && localPose && localPose->spatialPose && hierarchy && hierarchy->parentIndex)
+	{
+		const a3i16 *parentIndex = hierarchy->parentIndex;
+		a3_SpatialPoseDQ *objectPose = objectPose_out->spatialPose;
+		a3ui32 i;
+		a3i32 j;
+
+		// parents precede children, so one pass suffices
+		for (i = 0; i < hierarchy->numNodes; ++i)
+		{
+			j = parentIndex[i];
+			if (j >= 0)
+				a3spatialPoseDQConcat(objectPose + i, objectPose + j, localPose->spatialPose + i);
+			else
+				objectPose[i] = localPose->spatialPose[i];
+		}
+		return hierarchy->numNodes;
 	}
 	return -1;
 }
@@ -52,12 +358,765 @@ a3i32 a3kinematicsSolveInversePartial(const a3_HierarchyState *hierarchyState, c
 	if (hierarchyState && hierarchyState->poseGroup &&
 		firstIndex < hierarchyState->poseGroup->hierarchy->numNodes && nodeCount)
 	{
-		// ****TO-DO: implement inverse kinematics algorithm
-		//	- for all nodes starting at first index
+		const a3_Hierarchy *hierarchy = hierarchyState->poseGroup->hierarchy;
+		const a3i16 *parentIndex = hierarchy->parentIndex;
+		const a3mat4 *objectSpace = hierarchyState->objectSpace->transform;
+		a3mat4 *objectSpaceInverse = hierarchyState->objectSpaceInverse->transform;
+		a3mat4 *localSpace = hierarchyState->localSpace->transform;
+		a3ubyte *dirty = hierarchyState->nodeDirty;
+		const a3ui32 lastIndex = a3minimum(firstIndex + nodeCount, hierarchy->lodNodeCount[hierarchyState->lod]);
+		a3ui32 i, updated = 0;
+		a3i32 j;
+
+		//	- for all nodes starting at first index, up to the last node 
+		//		evaluated at the current detail level
 		//		- if node is not root (has parent node)
 		//			- local matrix = inverse parent object matrix * object matrix
 		//		- else
 		//			- copy object matrix to local matrix
+		for (i = firstIndex; i < lastIndex; ++i, ++updated)
+		{
+			j = parentIndex[i];
+			if (j >= 0)
+			{
+				if (dirty[j] & a3hierarchyStateDirty_objectInverse)
+				{
+					a3hierarchyStateInternalInvert(objectSpaceInverse + j, objectSpace + j, hierarchyState->scaleMode);
+
+					// the cache only stays valid if FK will not replace the parent
+					if (!(dirty[j] & a3hierarchyStateDirty_object))
+						dirty[j] &= ~a3hierarchyStateDirty_objectInverse;
+				}
+				a3kinematicsInternalProductAffine(localSpace + i, objectSpaceInverse + j, objectSpace + i);
+			}
+			else
+				localSpace[i] = objectSpace[i];
+		}
+		return updated;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// normalize vector, return its original length
+inline a3real a3kinematicsInternalNormalize(a3real3p v)
+{
+	const a3real len = a3sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+	if (len > a3real_zero)
+	{
+		const a3real lenInv = a3recip(len);
+		v[0] *= lenInv;
+		v[1] *= lenInv;
+		v[2] *= lenInv;
+	}
+	return len;
+}
+
+// rotate the basis of a transform by the shortest rotation taking unit 
+//	vector 'from' to unit vector 'to'; opposite vectors turn half way 
+//	around unit 'axis', which must be perpendicular to both (if null, any 
+//	perpendicular is used)
+inline void a3kinematicsInternalRotateBasis(a3mat4 *m, const a3real3p from, const a3real3p to, const a3real3p axis_opt)
+{
+	const a3real c = from[0] * to[0] + from[1] * to[1] + from[2] * to[2];
+	a3real r[3][3], k[3], axis[3], s, x, y, z;
+	a3ui32 i;
+	if (axis_opt)
+	{
+		axis[0] = axis_opt[0];
+		axis[1] = axis_opt[1];
+		axis[2] = axis_opt[2];
+	}
+	else
+	{
+		axis[0] = a3absolute(from[0]) < (a3real)0.9 ? a3real_zero : -from[2];
+		axis[1] = a3absolute(from[0]) < (a3real)0.9 ? from[2] : a3real_zero;
+		axis[2] = a3absolute(from[0]) < (a3real)0.9 ? -from[1] : from[0];
+		a3kinematicsInternalNormalize(axis);
+	}
+	if (c > (a3real)-0.9999)
+	{
+		// R = c * I + [k]x + k * k^T / (1 + c), k = from x to
+		k[0] = from[1] * to[2] - from[2] * to[1];
+		k[1] = from[2] * to[0] - from[0] * to[2];
+		k[2] = from[0] * to[1] - from[1] * to[0];
+		s = a3recip(a3real_one + c);
+		r[0][0] = c + k[0] * k[0] * s;
+		r[0][1] = k[0] * k[1] * s - k[2];
+		r[0][2] = k[0] * k[2] * s + k[1];
+		r[1][0] = k[1] * k[0] * s + k[2];
+		r[1][1] = c + k[1] * k[1] * s;
+		r[1][2] = k[1] * k[2] * s - k[0];
+		r[2][0] = k[2] * k[0] * s - k[1];
+		r[2][1] = k[2] * k[1] * s + k[0];
+		r[2][2] = c + k[2] * k[2] * s;
+	}
+	else
+	{
+		// R = 2 * n * n^T - I
+		r[0][0] = a3real_two * axis[0] * axis[0] - a3real_one;
+		r[0][1] = r[1][0] = a3real_two * axis[0] * axis[1];
+		r[0][2] = r[2][0] = a3real_two * axis[0] * axis[2];
+		r[1][1] = a3real_two * axis[1] * axis[1] - a3real_one;
+		r[1][2] = r[2][1] = a3real_two * axis[1] * axis[2];
+		r[2][2] = a3real_two * axis[2] * axis[2] - a3real_one;
+	}
+	for (i = 0; i < 3; ++i)
+	{
+		x = m->v[i].x;
+		y = m->v[i].y;
+		z = m->v[i].z;
+		m->v[i].x = r[0][0] * x + r[0][1] * y + r[0][2] * z;
+		m->v[i].y = r[1][0] * x + r[1][1] * y + r[1][2] * z;
+		m->v[i].z = r[2][0] * x + r[2][1] * y + r[2][2] * z;
+	}
+}
+
+// solve two-bone triangle: given root, mid and end positions, target and 
+//	pole, find new mid and end positions and the bend plane normal
+inline void a3kinematicsInternalTwoBonePositions(a3real3p mid_out, a3real3p end_out, a3real3p axis_out, 
+	const a3real3p root, const a3real3p mid, const a3real3p end, const a3real3p target, const a3real3p pole)
+{
+	a3real3 dir, bend, v;
+	a3real a, b, d, cosA, sinA, proj;
+
+	// bone lengths
+	v[0] = mid[0] - root[0];
+	v[1] = mid[1] - root[1];
+	v[2] = mid[2] - root[2];
+	a = a3kinematicsInternalNormalize(v);
+	v[0] = end[0] - mid[0];
+	v[1] = end[1] - mid[1];
+	v[2] = end[2] - mid[2];
+	b = a3kinematicsInternalNormalize(v);
+
+	// direction and distance to target, clamped to what the chain can reach
+	dir[0] = target[0] - root[0];
+	dir[1] = target[1] - root[1];
+	dir[2] = target[2] - root[2];
+	d = a3kinematicsInternalNormalize(dir);
+	if (d <= a3real_zero)
+	{
+		dir[0] = end[0] - root[0];
+		dir[1] = end[1] - root[1];
+		dir[2] = end[2] - root[2];
+		a3kinematicsInternalNormalize(dir);
+	}
+	d = a3clamp(a3absolute(a - b), a + b, d);
+
+	// law of cosines for the angle at the root
+	cosA = (a > a3real_zero && d > a3real_zero) ? (a * a + d * d - b * b) * a3recip(a3real_two * a * d) : a3real_one;
+	cosA = a3clamp(-a3real_one, a3real_one, cosA);
+	sinA = a3sqrt(a3real_one - cosA * cosA);
+
+	// bend direction: pole (or current mid if the pole is on the line) 
+	//	with its component along the target direction removed
+	bend[0] = pole[0] - root[0];
+	bend[1] = pole[1] - root[1];
+	bend[2] = pole[2] - root[2];
+	proj = bend[0] * dir[0] + bend[1] * dir[1] + bend[2] * dir[2];
+	bend[0] -= dir[0] * proj;
+	bend[1] -= dir[1] * proj;
+	bend[2] -= dir[2] * proj;
+	if (a3kinematicsInternalNormalize(bend) <= (a3real)0.0001)
+	{
+		bend[0] = mid[0] - root[0];
+		bend[1] = mid[1] - root[1];
+		bend[2] = mid[2] - root[2];
+		proj = bend[0] * dir[0] + bend[1] * dir[1] + bend[2] * dir[2];
+		bend[0] -= dir[0] * proj;
+		bend[1] -= dir[1] * proj;
+		bend[2] -= dir[2] * proj;
+		if (a3kinematicsInternalNormalize(bend) <= (a3real)0.0001)
+		{
+			// any perpendicular
+			bend[0] = a3absolute(dir[0]) < (a3real)0.9 ? a3real_zero : -dir[2];
+			bend[1] = a3absolute(dir[0]) < (a3real)0.9 ? dir[2] : a3real_zero;
+			bend[2] = a3absolute(dir[0]) < (a3real)0.9 ? -dir[1] : dir[0];
+			a3kinematicsInternalNormalize(bend);
+		}
+	}
+
+	// solved positions and plane normal
+	mid_out[0] = root[0] + (dir[0] * cosA + bend[0] * sinA) * a;
+	mid_out[1] = root[1] + (dir[1] * cosA + bend[1] * sinA) * a;
+	mid_out[2] = root[2] + (dir[2] * cosA + bend[2] * sinA) * a;
+	end_out[0] = root[0] + dir[0] * d;
+	end_out[1] = root[1] + dir[1] * d;
+	end_out[2] = root[2] + dir[2] * d;
+	axis_out[0] = dir[1] * bend[2] - dir[2] * bend[1];
+	axis_out[1] = dir[2] * bend[0] - dir[0] * bend[2];
+	axis_out[2] = dir[0] * bend[1] - dir[1] * bend[0];
+}
+
+// mark a node and its descendants dirty, but only up to 'lastIndex'; the 
+//	rest of the subtree is marked once by the caller when the solve is done
+inline void a3kinematicsInternalMarkDirtyRange(const a3_HierarchyState *hierarchyState, const a3ui32 nodeIndex, const a3ui32 lastIndex)
+{
+	const a3i16 *parentIndex = hierarchyState->poseGroup->hierarchy->parentIndex;
+	a3ubyte *dirty = hierarchyState->nodeDirty;
+	a3ui32 i;
+	dirty[nodeIndex] = a3hierarchyStateDirty_all;
+	for (i = nodeIndex + 1; i <= lastIndex; ++i)
+		if (parentIndex[i] >= (a3i32)nodeIndex && (dirty[parentIndex[i]] & a3hierarchyStateDirty_object))
+			dirty[i] = a3hierarchyStateDirty_all;
+}
+
+// aim a node so that the direction to one of its descendants points at a 
+//	goal position, then re-run FK on its subtree up to 'lastIndex'; the 
+//	caller recovers the local pose and updates later nodes once at the end
+inline a3i32 a3kinematicsInternalAimNode(const a3_HierarchyState *hierarchyState, const a3ui32 nodeIndex, const a3ui32 childIndex, const a3real3p goal, const a3real3p axis, const a3ui32 lastIndex)
+{
+	a3mat4 *objectSpace = hierarchyState->objectSpace->transform;
+	a3real3 from, to;
+	from[0] = objectSpace[childIndex].m30 - objectSpace[nodeIndex].m30;
+	from[1] = objectSpace[childIndex].m31 - objectSpace[nodeIndex].m31;
+	from[2] = objectSpace[childIndex].m32 - objectSpace[nodeIndex].m32;
+	to[0] = goal[0] - objectSpace[nodeIndex].m30;
+	to[1] = goal[1] - objectSpace[nodeIndex].m31;
+	to[2] = goal[2] - objectSpace[nodeIndex].m32;
+	if (a3kinematicsInternalNormalize(from) > a3real_zero && a3kinematicsInternalNormalize(to) > a3real_zero)
+		a3kinematicsInternalRotateBasis(objectSpace + nodeIndex, from, to, axis);
+	a3kinematicsSolveInversePartial(hierarchyState, nodeIndex, 1);
+	a3kinematicsInternalMarkDirtyRange(hierarchyState, nodeIndex, lastIndex);
+	return a3kinematicsSolveForwardPartial(hierarchyState, nodeIndex, lastIndex + 1 - nodeIndex);
+}
+
+// validate two-bone chain
+inline a3boolean a3kinematicsInternalTwoBoneValid(const a3_HierarchyState *hierarchyState, const a3ui32 rootIndex, const a3ui32 midIndex, const a3ui32 endIndex)
+{
+	return (hierarchyState && hierarchyState->poseGroup && 
+		endIndex < hierarchyState->poseGroup->hierarchy->lodNodeCount[hierarchyState->lod] && 
+		rootIndex < midIndex && midIndex < endIndex && 
+		a3hierarchyIsAncestorNode(hierarchyState->poseGroup->hierarchy, rootIndex, midIndex) == 1 && 
+		a3hierarchyIsAncestorNode(hierarchyState->poseGroup->hierarchy, midIndex, endIndex) == 1);
+}
+
+// write a solved triangle back: root swings the mid node into place, then 
+//	the mid node swings the end node; both aims only refresh nodes up to the 
+//	end, poses and the rest of the subtree are left to the caller
+inline void a3kinematicsInternalTwoBoneAim(const a3_HierarchyState *hierarchyState, const a3ui32 rootIndex, const a3ui32 midIndex, const a3ui32 endIndex, const a3real3p midGoal, const a3real3p endGoal, const a3real3p axis)
+{
+	a3kinematicsInternalAimNode(hierarchyState, rootIndex, midIndex, midGoal, axis, endIndex);
+	a3kinematicsInternalAimNode(hierarchyState, midIndex, endIndex, endGoal, axis, endIndex);
+}
+
+// mark the roots of a run of solved requests on one state, then update 
+//	all of their subtrees with one sweep and one FK pass
+inline a3i32 a3kinematicsInternalTwoBoneFlush(const a3_KinematicsTwoBone requests[], const a3ui32 requestCount)
+{
+	const a3_HierarchyState *hierarchyState = requests->hierarchyState;
+	a3ui32 i, firstIndex = 0;
+	a3boolean any = 0;
+	for (i = 0; i < requestCount; ++i)
+		if (a3kinematicsInternalTwoBoneValid(hierarchyState, requests[i].rootIndex, requests[i].midIndex, requests[i].endIndex))
+		{
+			hierarchyState->nodeDirty[requests[i].rootIndex] = a3hierarchyStateDirty_all;
+			if (!any || requests[i].rootIndex < firstIndex)
+				firstIndex = requests[i].rootIndex;
+			any = 1;
+		}
+	if (any)
+	{
+		a3hierarchyStateMarkDirty(hierarchyState, firstIndex);
+		return a3kinematicsSolveForwardPartial(hierarchyState, firstIndex, hierarchyState->poseGroup->hierarchy->numNodes - firstIndex);
+	}
+	return 0;
+}
+
+// solve one valid two-bone chain and recover its poses; the rest of the 
+//	subtree is left to the caller
+inline void a3kinematicsInternalTwoBoneSolve(const a3_HierarchyState *hierarchyState, const a3ui32 rootIndex, const a3ui32 midIndex, const a3ui32 endIndex, const a3real3p target, const a3real3p pole)
+{
+	const a3mat4 *objectSpace = hierarchyState->objectSpace->transform;
+	a3real3 root, mid, end, midGoal, endGoal, axis;
+	root[0] = objectSpace[rootIndex].m30;
+	root[1] = objectSpace[rootIndex].m31;
+	root[2] = objectSpace[rootIndex].m32;
+	mid[0] = objectSpace[midIndex].m30;
+	mid[1] = objectSpace[midIndex].m31;
+	mid[2] = objectSpace[midIndex].m32;
+	end[0] = objectSpace[endIndex].m30;
+	end[1] = objectSpace[endIndex].m31;
+	end[2] = objectSpace[endIndex].m32;
+	a3kinematicsInternalTwoBonePositions(midGoal, endGoal, axis, root, mid, end, target, pole);
+	a3kinematicsInternalTwoBoneAim(hierarchyState, rootIndex, midIndex, endIndex, midGoal, endGoal, axis);
+	a3spatialPoseRestore(hierarchyState->samplePose->spatialPose + rootIndex, hierarchyState->localSpace->transform + rootIndex);
+	a3spatialPoseRestore(hierarchyState->samplePose->spatialPose + midIndex, hierarchyState->localSpace->transform + midIndex);
+}
+
+// two-bone IK solver
+a3i32 a3kinematicsSolveTwoBone(const a3_HierarchyState *hierarchyState, const a3ui32 rootIndex, const a3ui32 midIndex, const a3ui32 endIndex, const a3real3p target, const a3real3p pole)
+{
+	if (target && pole && a3kinematicsInternalTwoBoneValid(hierarchyState, rootIndex, midIndex, endIndex))
+	{
+		a3kinematicsInternalTwoBoneSolve(hierarchyState, rootIndex, midIndex, endIndex, target, pole);
+		a3hierarchyStateMarkDirty(hierarchyState, rootIndex);
+		return a3kinematicsSolveForwardPartial(hierarchyState, rootIndex, hierarchyState->poseGroup->hierarchy->numNodes - rootIndex);
+	}
+	return -1;
+}
+
+
+#ifdef A3_SPATIALPOSE_SSE
+// lane select: mask ? a : b
+inline __m128 a3kinematicsInternalLanesSelect(const __m128 mask, const __m128 a, const __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// lane dot product
+inline __m128 a3kinematicsInternalLanesDot(const __m128 a[3], const __m128 b[3])
+{
+	return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+}
+
+// lane normalize, return original lengths
+inline __m128 a3kinematicsInternalLanesNormalize(__m128 v[3])
+{
+	const __m128 len = _mm_sqrt_ps(a3kinematicsInternalLanesDot(v, v));
+	const __m128 lenInv = a3kinematicsInternalLanesSelect(_mm_cmpgt_ps(len, _mm_setzero_ps()), _mm_div_ps(_mm_set1_ps(a3real_one), len), _mm_setzero_ps());
+	v[0] = _mm_mul_ps(v[0], lenInv);
+	v[1] = _mm_mul_ps(v[1], lenInv);
+	v[2] = _mm_mul_ps(v[2], lenInv);
+	return len;
+}
+
+// lane difference
+inline void a3kinematicsInternalLanesDiff(__m128 v_out[3], const __m128 a[3], const __m128 b[3])
+{
+	v_out[0] = _mm_sub_ps(a[0], b[0]);
+	v_out[1] = _mm_sub_ps(a[1], b[1]);
+	v_out[2] = _mm_sub_ps(a[2], b[2]);
+}
+
+// lane remove component along unit direction, normalize, and replace 
+//	lanes that end up too short with a fallback
+inline void a3kinematicsInternalLanesPerpendicular(__m128 v[3], const __m128 dir[3], const __m128 fallback[3])
+{
+	const __m128 proj = a3kinematicsInternalLanesDot(v, dir);
+	__m128 mask;
+	v[0] = _mm_sub_ps(v[0], _mm_mul_ps(dir[0], proj));
+	v[1] = _mm_sub_ps(v[1], _mm_mul_ps(dir[1], proj));
+	v[2] = _mm_sub_ps(v[2], _mm_mul_ps(dir[2], proj));
+	mask = _mm_cmpgt_ps(a3kinematicsInternalLanesNormalize(v), _mm_set1_ps((a3real)0.0001));
+	v[0] = a3kinematicsInternalLanesSelect(mask, v[0], fallback[0]);
+	v[1] = a3kinematicsInternalLanesSelect(mask, v[1], fallback[1]);
+	v[2] = a3kinematicsInternalLanesSelect(mask, v[2], fallback[2]);
+}
+
+// solve two-bone triangle for 4 requests, same steps as the scalar version
+inline void a3kinematicsInternalTwoBonePositionsLanes(__m128 mid_out[3], __m128 end_out[3], __m128 axis_out[3], 
+	const __m128 root[3], const __m128 mid[3], const __m128 end[3], const __m128 target[3], const __m128 pole[3])
+{
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(a3real_one), signBit = _mm_set1_ps(-0.0f);
+	__m128 v[3], dir[3], bend[3], other[3], a, b, d, cosA, sinA, mask;
+	a3ui32 k;
+
+	// bone lengths
+	a3kinematicsInternalLanesDiff(v, mid, root);
+	a = a3kinematicsInternalLanesNormalize(v);
+	a3kinematicsInternalLanesDiff(v, end, mid);
+	b = a3kinematicsInternalLanesNormalize(v);
+
+	// direction and distance to target, clamped to what the chain can reach
+	a3kinematicsInternalLanesDiff(dir, target, root);
+	d = a3kinematicsInternalLanesNormalize(dir);
+	a3kinematicsInternalLanesDiff(v, end, root);
+	a3kinematicsInternalLanesNormalize(v);
+	mask = _mm_cmpgt_ps(d, zero);
+	for (k = 0; k < 3; ++k)
+		dir[k] = a3kinematicsInternalLanesSelect(mask, dir[k], v[k]);
+	d = _mm_min_ps(_mm_max_ps(d, _mm_andnot_ps(signBit, _mm_sub_ps(a, b))), _mm_add_ps(a, b));
+
+	// law of cosines for the angle at the root
+	mask = _mm_and_ps(_mm_cmpgt_ps(a, zero), _mm_cmpgt_ps(d, zero));
+	cosA = _mm_div_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(a, a), _mm_mul_ps(d, d)), _mm_mul_ps(b, b)), _mm_mul_ps(_mm_set1_ps(a3real_two), _mm_mul_ps(a, d)));
+	cosA = a3kinematicsInternalLanesSelect(mask, cosA, one);
+	cosA = _mm_min_ps(_mm_max_ps(cosA, _mm_sub_ps(zero, one)), one);
+	sinA = _mm_sqrt_ps(_mm_sub_ps(one, _mm_mul_ps(cosA, cosA)));
+
+	// bend direction: pole, else current mid, else any perpendicular
+	mask = _mm_cmplt_ps(_mm_andnot_ps(signBit, dir[0]), _mm_set1_ps((a3real)0.9));
+	other[0] = a3kinematicsInternalLanesSelect(mask, zero, _mm_sub_ps(zero, dir[2]));
+	other[1] = a3kinematicsInternalLanesSelect(mask, dir[2], zero);
+	other[2] = a3kinematicsInternalLanesSelect(mask, _mm_sub_ps(zero, dir[1]), dir[0]);
+	a3kinematicsInternalLanesNormalize(other);
+	a3kinematicsInternalLanesDiff(v, mid, root);
+	a3kinematicsInternalLanesPerpendicular(v, dir, other);
+	a3kinematicsInternalLanesDiff(bend, pole, root);
+	a3kinematicsInternalLanesPerpendicular(bend, dir, v);
+
+	// solved positions and plane normal
+	for (k = 0; k < 3; ++k)
+	{
+		mid_out[k] = _mm_add_ps(root[k], _mm_mul_ps(_mm_add_ps(_mm_mul_ps(dir[k], cosA), _mm_mul_ps(bend[k], sinA)), a));
+		end_out[k] = _mm_add_ps(root[k], _mm_mul_ps(dir[k], d));
+	}
+	axis_out[0] = _mm_sub_ps(_mm_mul_ps(dir[1], bend[2]), _mm_mul_ps(dir[2], bend[1]));
+	axis_out[1] = _mm_sub_ps(_mm_mul_ps(dir[2], bend[0]), _mm_mul_ps(dir[0], bend[2]));
+	axis_out[2] = _mm_sub_ps(_mm_mul_ps(dir[0], bend[1]), _mm_mul_ps(dir[1], bend[0]));
+}
+#endif	// A3_SPATIALPOSE_SSE
+
+
+// batched two-bone IK solver
+a3i32 a3kinematicsSolveTwoBoneMany(const a3_KinematicsTwoBone requests[], const a3ui32 requestCount)
+{
+	if (requests)
+	{
+		const a3_KinematicsTwoBone *request;
+		a3i32 solved = 0;
+		a3ui32 n = 0, run;
+
+#ifdef A3_SPATIALPOSE_SSE
+		// gathered inputs and scattered outputs: [component][lane]
+		a3real root[3][4], mid[3][4], end[3][4], target[3][4], pole[3][4];
+		a3real midGoal[3][4], endGoal[3][4], axis[3][4];
+		__m128 rootL[3], midL[3], endL[3], targetL[3], poleL[3];
+		__m128 midGoalL[3], endGoalL[3], axisL[3];
+		a3boolean valid[4];
+		const a3mat4 *objectSpace;
+		a3real3 midGoalLane, endGoalLane, axisLane;
+		a3mat4 local[8];
+		a3_SpatialPoseBlock block[2];
+		a3_SpatialPose restored[8];
+		a3ui32 k, c;
+
+		for (; n + 4 <= requestCount; n += 4)
+		{
+			// gather: invalid lanes are zeroed and skipped on write-back
+			for (k = 0; k < 4; ++k)
+			{
+				request = requests + n + k;
+				valid[k] = a3kinematicsInternalTwoBoneValid(request->hierarchyState, request->rootIndex, request->midIndex, request->endIndex);
+				for (c = 0; c < 3; ++c)
+				{
+					if (valid[k])
+					{
+						objectSpace = request->hierarchyState->objectSpace->transform;
+						root[c][k] = objectSpace[request->rootIndex].v[3].v[c];
+						mid[c][k] = objectSpace[request->midIndex].v[3].v[c];
+						end[c][k] = objectSpace[request->endIndex].v[3].v[c];
+						target[c][k] = request->target.v[c];
+						pole[c][k] = request->pole.v[c];
+					}
+					else
+						root[c][k] = mid[c][k] = end[c][k] = target[c][k] = pole[c][k] = a3real_zero;
+				}
+			}
+
+			// solve 4 triangles at once
+			for (c = 0; c < 3; ++c)
+			{
+				rootL[c] = _mm_loadu_ps(root[c]);
+				midL[c] = _mm_loadu_ps(mid[c]);
+				endL[c] = _mm_loadu_ps(end[c]);
+				targetL[c] = _mm_loadu_ps(target[c]);
+				poleL[c] = _mm_loadu_ps(pole[c]);
+			}
+			a3kinematicsInternalTwoBonePositionsLanes(midGoalL, endGoalL, axisL, rootL, midL, endL, targetL, poleL);
+			for (c = 0; c < 3; ++c)
+			{
+				_mm_storeu_ps(midGoal[c], midGoalL[c]);
+				_mm_storeu_ps(endGoal[c], endGoalL[c]);
+				_mm_storeu_ps(axis[c], axisL[c]);
+			}
+
+			// aim one lane at a time and gather the new local matrices; 
+			//	invalid lanes restore identity and are not scattered
+			for (k = 0; k < 4; ++k)
+			{
+				if (!valid[k])
+				{
+					a3real4x4SetIdentity(local[2 * k].m);
+					a3real4x4SetIdentity(local[2 * k + 1].m);
+					continue;
+				}
+				request = requests + n + k;
+				for (c = 0; c < 3; ++c)
+				{
+					midGoalLane[c] = midGoal[c][k];
+					endGoalLane[c] = endGoal[c][k];
+					axisLane[c] = axis[c][k];
+				}
+				a3kinematicsInternalTwoBoneAim(request->hierarchyState, request->rootIndex, request->midIndex, request->endIndex, midGoalLane, endGoalLane, axisLane);
+				local[2 * k] = request->hierarchyState->localSpace->transform[request->rootIndex];
+				local[2 * k + 1] = request->hierarchyState->localSpace->transform[request->midIndex];
+				++solved;
+			}
+
+			// recover all 8 poses at once and scatter
+			a3spatialPoseRestoreBatch(block, local, 8);
+			a3spatialPoseBlockUnpack(restored, block, 8);
+			for (k = 0; k < 4; ++k)
+			{
+				if (!valid[k])
+					continue;
+				request = requests + n + k;
+				request->hierarchyState->samplePose->spatialPose[request->rootIndex] = restored[2 * k];
+				request->hierarchyState->samplePose->spatialPose[request->midIndex] = restored[2 * k + 1];
+			}
+		}
+#endif	// A3_SPATIALPOSE_SSE
+
+		// remaining requests one at a time
+		for (; n < requestCount; ++n)
+		{
+			request = requests + n;
+			if (a3kinematicsInternalTwoBoneValid(request->hierarchyState, request->rootIndex, request->midIndex, request->endIndex))
+			{
+				a3kinematicsInternalTwoBoneSolve(request->hierarchyState, request->rootIndex, request->midIndex, request->endIndex, request->target.v, request->pole.v);
+				++solved;
+			}
+		}
+
+		// one dirty sweep and one FK pass per run of adjacent requests 
+		//	that share a state
+		for (n = 0; n < requestCount; n += run)
+		{
+			for (run = 1; n + run < requestCount && requests[n + run].hierarchyState == requests[n].hierarchyState; ++run);
+			a3kinematicsInternalTwoBoneFlush(requests + n, run);
+		}
+		return solved;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// create chain
+a3i32 a3kinematicsChainCreate(a3_KinematicsChain *chain_out, const a3_Hierarchy *hierarchy, const a3ui32 firstIndex, const a3ui32 nodeCount, const a3_KinematicsChainMethod method)
+{
+	if (chain_out && !chain_out->solution && hierarchy && hierarchy->parentIndex && 
+		nodeCount >= 2 && firstIndex + nodeCount <= hierarchy->numNodes && method <= a3kinematicsChain_ccd)
+	{
+		// memory: solution, then positions, then lengths (one malloc)
+		const a3ui32 dataSize = (sizeof(a3vec4) + sizeof(a3vec3) + sizeof(a3real)) * nodeCount;
+		a3ui32 i;
+
+		// each node must be the parent of the next
+		for (i = firstIndex + 1; i < firstIndex + nodeCount; ++i)
+			if (hierarchy->parentIndex[i] != (a3i32)i - 1)
+				return -1;
+
+		chain_out->solution = (a3vec4 *)malloc(dataSize);
+		chain_out->position = (a3vec3 *)(chain_out->solution + nodeCount);
+		chain_out->length = (a3real *)(chain_out->position + nodeCount);
+		chain_out->firstIndex = firstIndex;
+		chain_out->nodeCount = nodeCount;
+		chain_out->method = method;
+		chain_out->tolerance = (a3real)0.001;
+		chain_out->iterationMax = 16;
+		chain_out->warmStart = chain_out->solutionValid = 0;
+		chain_out->iterations = 0;
+		chain_out->error = a3real_zero;
+		chain_out->time = 0.0;
+		a3kinematicsChainResetCounters(chain_out);
+		return nodeCount;
+	}
+	return -1;
+}
+
+// release chain
+a3i32 a3kinematicsChainRelease(a3_KinematicsChain *chain)
+{
+	if (chain && chain->solution)
+	{
+		free(chain->solution);
+		chain->solution = 0;
+		chain->position = 0;
+		chain->length = 0;
+		chain->nodeCount = 0;
+		chain->solutionValid = 0;
+		return 1;
+	}
+	return -1;
+}
+
+// reset counters
+a3i32 a3kinematicsChainResetCounters(a3_KinematicsChain *chain)
+{
+	if (chain)
+	{
+		chain->solveTotal = chain->iterationTotal = 0;
+		chain->timeTotal = 0.0;
+		return 1;
+	}
+	return -1;
+}
+
+
+// distance between end effector and target
+inline a3real a3kinematicsInternalChainError(const a3mat4 *end, const a3real3p target)
+{
+	const a3real x = target[0] - end->m30, y = target[1] - end->m31, z = target[2] - end->m32;
+	return a3sqrt(x * x + y * y + z * z);
+}
+
+// move point 'p' to lie at distance 'len' from 'anchor' along their line
+inline void a3kinematicsInternalChainPlace(a3vec3 *p, const a3vec3 *anchor, const a3real len)
+{
+	a3real3 d;
+	d[0] = p->x - anchor->x;
+	d[1] = p->y - anchor->y;
+	d[2] = p->z - anchor->z;
+	a3kinematicsInternalNormalize(d);
+	p->x = anchor->x + d[0] * len;
+	p->y = anchor->y + d[1] * len;
+	p->z = anchor->z + d[2] * len;
+}
+
+// FABRIK: solve positions, then aim each node at its solved child
+inline a3ui32 a3kinematicsInternalSolveFABRIK(const a3_HierarchyState *hierarchyState, a3_KinematicsChain *chain, const a3real3p target)
+{
+	const a3mat4 *objectSpace = hierarchyState->objectSpace->transform + chain->firstIndex;
+	const a3ui32 n = chain->nodeCount;
+	a3vec3 *p = chain->position, root;
+	a3real *len = chain->length, reach = a3real_zero, x, y, z;
+	a3ui32 k, iterations = 0;
+
+	for (k = 0; k < n; ++k)
+	{
+		p[k].x = objectSpace[k].m30;
+		p[k].y = objectSpace[k].m31;
+		p[k].z = objectSpace[k].m32;
+	}
+	for (k = 0; k + 1 < n; ++k)
+	{
+		x = p[k + 1].x - p[k].x;
+		y = p[k + 1].y - p[k].y;
+		z = p[k + 1].z - p[k].z;
+		len[k] = a3sqrt(x * x + y * y + z * z);
+		reach += len[k];
+	}
+	root = p[0];
+
+	x = target[0] - root.x;
+	y = target[1] - root.y;
+	z = target[2] - root.z;
+	if (x * x + y * y + z * z >= reach * reach)
+	{
+		// out of reach: straighten toward target
+		for (k = 1; k < n; ++k)
+		{
+			p[k].x = target[0];
+			p[k].y = target[1];
+			p[k].z = target[2];
+			a3kinematicsInternalChainPlace(p + k, p + k - 1, len[k - 1]);
+		}
+		iterations = 1;
+	}
+	else
+	{
+		while (iterations < chain->iterationMax)
+		{
+			++iterations;
+
+			// backward: end on target, each node placed toward its child
+			p[n - 1].x = target[0];
+			p[n - 1].y = target[1];
+			p[n - 1].z = target[2];
+			for (k = n - 1; k > 0; --k)
+				a3kinematicsInternalChainPlace(p + k - 1, p + k, len[k - 1]);
+
+			// forward: root back in place, each node placed toward its parent
+			p[0] = root;
+			for (k = 1; k < n; ++k)
+				a3kinematicsInternalChainPlace(p + k, p + k - 1, len[k - 1]);
+
+			x = target[0] - p[n - 1].x;
+			y = target[1] - p[n - 1].y;
+			z = target[2] - p[n - 1].z;
+			if (x * x + y * y + z * z <= chain->tolerance * chain->tolerance)
+				break;
+		}
+	}
+
+	// apply: each node is aimed after its parent has moved; only the 
+	//	chain itself is kept current, the rest of the subtree is left dirty
+	for (k = 0; k + 1 < n; ++k)
+		a3kinematicsInternalAimNode(hierarchyState, chain->firstIndex + k, chain->firstIndex + k + 1, p[k + 1].v, 0, chain->firstIndex + n - 1);
+	return iterations;
+}
+
+// CCD: from the node nearest the end, aim the end effector at the target
+inline a3ui32 a3kinematicsInternalSolveCCD(const a3_HierarchyState *hierarchyState, a3_KinematicsChain *chain, const a3real3p target)
+{
+	const a3mat4 *objectSpace = hierarchyState->objectSpace->transform;
+	const a3ui32 endIndex = chain->firstIndex + chain->nodeCount - 1;
+	a3ui32 k, iterations = 0;
+	while (iterations < chain->iterationMax)
+	{
+		++iterations;
+		for (k = endIndex; k > chain->firstIndex; --k)
+			a3kinematicsInternalAimNode(hierarchyState, k - 1, endIndex, target, 0, endIndex);
+		if (a3kinematicsInternalChainError(objectSpace + endIndex, target) <= chain->tolerance)
+			break;
+	}
+	return iterations;
+}
+
+// chain IK solver
+a3i32 a3kinematicsSolveChain(const a3_HierarchyState *hierarchyState, a3_KinematicsChain *chain, const a3real3p target)
+{
+	if (hierarchyState && hierarchyState->poseGroup && chain && chain->solution && target && 
+		chain->firstIndex + chain->nodeCount <= hierarchyState->poseGroup->hierarchy->lodNodeCount[hierarchyState->lod])
+	{
+		a3_SpatialPose *pose = hierarchyState->samplePose->spatialPose + chain->firstIndex;
+		a3mat4 *localSpace = hierarchyState->localSpace->transform + chain->firstIndex;
+		const a3mat4 *end = hierarchyState->objectSpace->transform + chain->firstIndex + chain->nodeCount - 1;
+		a3_Timer timer[1] = { 0 };
+		a3ui32 k;
+
+		a3timerSet(timer, 0.0);
+		a3timerStart(timer);
+
+		// warm start: last solution's rotations replace the incoming ones
+		if (chain->warmStart && chain->solutionValid)
+		{
+			for (k = 0; k < chain->nodeCount; ++k)
+			{
+				pose[k].orientation = chain->solution[k];
+				a3spatialPoseConvert(localSpace + k, pose + k);
+			}
+			a3kinematicsInternalMarkDirtyRange(hierarchyState, chain->firstIndex, chain->firstIndex + chain->nodeCount - 1);
+			a3kinematicsSolveForwardPartial(hierarchyState, chain->firstIndex, chain->nodeCount);
+		}
+
+		// early out if already within tolerance
+		chain->iterations = 0;
+		if (a3kinematicsInternalChainError(end, target) > chain->tolerance)
+			chain->iterations = chain->method == a3kinematicsChain_ccd 
+				? a3kinematicsInternalSolveCCD(hierarchyState, chain, target) 
+				: a3kinematicsInternalSolveFABRIK(hierarchyState, chain, target);
+		chain->error = a3kinematicsInternalChainError(end, target);
+
+		// aims only touched matrices; recover the aimed nodes' poses
+		if (chain->iterations)
+			for (k = 0; k + 1 < chain->nodeCount; ++k)
+				a3spatialPoseRestore(pose + k, localSpace + k);
+
+		// iterations only kept the chain current; mark its subtree and run 
+		//	one FK pass for the rest
+		a3hierarchyStateMarkDirty(hierarchyState, chain->firstIndex);
+		a3kinematicsSolveForwardPartial(hierarchyState, chain->firstIndex, hierarchyState->poseGroup->hierarchy->numNodes - chain->firstIndex);
+
+		// keep solution for next time
+		for (k = 0; k < chain->nodeCount; ++k)
+			chain->solution[k] = pose[k].orientation;
+		chain->solutionValid = 1;
+
+		// counters
+		a3timerUpdate(timer);
+		chain->time = timer->totalTime;
+		chain->timeTotal += chain->time;
+		chain->iterationTotal += chain->iterations;
+		++chain->solveTotal;
+		return chain->iterations;
 	}
 	return -1;
 }
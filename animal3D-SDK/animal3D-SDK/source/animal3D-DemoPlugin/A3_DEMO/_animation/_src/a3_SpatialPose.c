@@ -24,9 +24,508 @@
 
 #include "../a3_SpatialPose.h"
 
+#ifdef A3_SPATIALPOSE_SSE
+#include <emmintrin.h>
+#endif	// A3_SPATIALPOSE_SSE
+
+
+//-----------------------------------------------------------------------------
+
+// transpose poses into blocks
+a3i32 a3spatialPoseBlockPack(a3_SpatialPoseBlock *blocks_out, const a3_SpatialPose *spatialPoses_in, const a3ui32 count)
+{
+	if (blocks_out && spatialPoses_in)
+	{
+		const a3ui32 total = a3spatialPoseBlockGetCount(count) * a3poseBlock_size;
+		a3_SpatialPose identity[1];
+		const a3_SpatialPose *pose;
+		a3_SpatialPoseBlock *block;
+		a3ui32 i, j, k;
+		a3spatialPoseReset(identity);
+		for (i = 0; i < total; ++i)
+		{
+			pose = i < count ? spatialPoses_in + i : identity;
+			block = blocks_out + i / a3poseBlock_size;
+			j = i % a3poseBlock_size;
+			for (k = 0; k < 4; ++k)
+				block->orientation[k][j] = pose->orientation.v[k];
+			for (k = 0; k < 3; ++k)
+			{
+				block->scale[k][j] = pose->scale.v[k];
+				block->translation[k][j] = pose->translation.v[k];
+			}
+		}
+		return count;
+	}
+	return -1;
+}
+
+// transpose blocks back into poses
+a3i32 a3spatialPoseBlockUnpack(a3_SpatialPose *spatialPoses_out, const a3_SpatialPoseBlock *blocks_in, const a3ui32 count)
+{
+	if (spatialPoses_out && blocks_in)
+	{
+		a3_SpatialPose *pose;
+		const a3_SpatialPoseBlock *block;
+		a3ui32 i, j, k;
+		for (i = 0; i < count; ++i)
+		{
+			pose = spatialPoses_out + i;
+			block = blocks_in + i / a3poseBlock_size;
+			j = i % a3poseBlock_size;
+			for (k = 0; k < 4; ++k)
+				pose->orientation.v[k] = block->orientation[k][j];
+			for (k = 0; k < 3; ++k)
+			{
+				pose->scale.v[k] = block->scale[k][j];
+				pose->translation.v[k] = block->translation[k][j];
+			}
+		}
+		return count;
+	}
+	return -1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+// scalar reference for batch conversion
+// operation order matches the SSE path exactly so results are identical
+a3i32 a3spatialPoseConvertBatchScalar(a3mat4 *matrices_out, const a3_SpatialPoseBlock *spatialPoses_in, const a3ui32 count)
+{
+	if (matrices_out && spatialPoses_in)
+	{
+		const a3_SpatialPoseBlock *block;
+		a3mat4 *m;
+		a3real qx, qy, qz, qw, sx, sy, sz;
+		a3real x2, y2, z2, xx, yy, zz, xy, yz, zx, wx, wy, wz;
+		a3ui32 i, j;
+		for (i = 0; i < count; ++i)
+		{
+			block = spatialPoses_in + i / a3poseBlock_size;
+			j = i % a3poseBlock_size;
+			m = matrices_out + i;
+
+			qx = block->orientation[0][j];
+			qy = block->orientation[1][j];
+			qz = block->orientation[2][j];
+			qw = block->orientation[3][j];
+			sx = block->scale[0][j];
+			sy = block->scale[1][j];
+			sz = block->scale[2][j];
+			x2 = qx + qx;
+			y2 = qy + qy;
+			z2 = qz + qz;
+			xx = qx * x2;
+			yy = qy * y2;
+			zz = qz * z2;
+			xy = qx * y2;
+			yz = qy * z2;
+			zx = qz * x2;
+			wx = qw * x2;
+			wy = qw * y2;
+			wz = qw * z2;
+
+			m->m00 = (a3real_one - yy - zz) * sx;
+			m->m01 = (xy + wz) * sx;
+			m->m02 = (zx - wy) * sx;
+			m->m03 = a3real_zero;
+			m->m10 = (xy - wz) * sy;
+			m->m11 = (a3real_one - zz - xx) * sy;
+			m->m12 = (yz + wx) * sy;
+			m->m13 = a3real_zero;
+			m->m20 = (zx + wy) * sz;
+			m->m21 = (yz - wx) * sz;
+			m->m22 = (a3real_one - xx - yy) * sz;
+			m->m23 = a3real_zero;
+			m->m30 = block->translation[0][j];
+			m->m31 = block->translation[1][j];
+			m->m32 = block->translation[2][j];
+			m->m33 = a3real_one;
+		}
+		return count;
+	}
+	return -1;
+}
+
+// convert a batch of poses to matrices
+a3i32 a3spatialPoseConvertBatch(a3mat4 *matrices_out, const a3_SpatialPoseBlock *spatialPoses_in, const a3ui32 count)
+{
+#ifdef A3_SPATIALPOSE_SSE
+	if (matrices_out && spatialPoses_in)
+	{
+		const __m128 one = _mm_set1_ps(a3real_one), zero = _mm_setzero_ps();
+		const a3_SpatialPoseBlock *block = spatialPoses_in;
+		a3mat4 *m = matrices_out, tmp[a3poseBlock_size];
+		__m128 qx, qy, qz, qw, sx, sy, sz;
+		__m128 x2, y2, z2, xx, yy, zz, xy, yz, zx, wx, wy, wz;
+		__m128 c0, c1, c2, c3;
+		a3ui32 i, j, n;
+		for (i = 0; i < count; i += a3poseBlock_size, ++block, m += a3poseBlock_size)
+		{
+			// lanes are poses; block arrays are 16-byte aligned only if the 
+			//	caller's storage is, so load unaligned
+			qx = _mm_loadu_ps(block->orientation[0]);
+			qy = _mm_loadu_ps(block->orientation[1]);
+			qz = _mm_loadu_ps(block->orientation[2]);
+			qw = _mm_loadu_ps(block->orientation[3]);
+			sx = _mm_loadu_ps(block->scale[0]);
+			sy = _mm_loadu_ps(block->scale[1]);
+			sz = _mm_loadu_ps(block->scale[2]);
+			x2 = _mm_add_ps(qx, qx);
+			y2 = _mm_add_ps(qy, qy);
+			z2 = _mm_add_ps(qz, qz);
+			xx = _mm_mul_ps(qx, x2);
+			yy = _mm_mul_ps(qy, y2);
+			zz = _mm_mul_ps(qz, z2);
+			xy = _mm_mul_ps(qx, y2);
+			yz = _mm_mul_ps(qy, z2);
+			zx = _mm_mul_ps(qz, x2);
+			wx = _mm_mul_ps(qw, x2);
+			wy = _mm_mul_ps(qw, y2);
+			wz = _mm_mul_ps(qw, z2);
+
+			// write to temporary if block is partial
+			n = a3minimum(count - i, a3poseBlock_size);
+			if (n < a3poseBlock_size)
+				m = tmp;
+
+			// each column is computed for all four poses (one element per 
+			//	register), then transposed so each register holds one 
+			//	pose's column
+			c0 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, yy), zz), sx);
+			c1 = _mm_mul_ps(_mm_add_ps(xy, wz), sx);
+			c2 = _mm_mul_ps(_mm_sub_ps(zx, wy), sx);
+			c3 = zero;
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+			_mm_storeu_ps(m[0].v[0].v, c0);
+			_mm_storeu_ps(m[1].v[0].v, c1);
+			_mm_storeu_ps(m[2].v[0].v, c2);
+			_mm_storeu_ps(m[3].v[0].v, c3);
+
+			c0 = _mm_mul_ps(_mm_sub_ps(xy, wz), sy);
+			c1 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, zz), xx), sy);
+			c2 = _mm_mul_ps(_mm_add_ps(yz, wx), sy);
+			c3 = zero;
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+			_mm_storeu_ps(m[0].v[1].v, c0);
+			_mm_storeu_ps(m[1].v[1].v, c1);
+			_mm_storeu_ps(m[2].v[1].v, c2);
+			_mm_storeu_ps(m[3].v[1].v, c3);
+
+			c0 = _mm_mul_ps(_mm_add_ps(zx, wy), sz);
+			c1 = _mm_mul_ps(_mm_sub_ps(yz, wx), sz);
+			c2 = _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(one, xx), yy), sz);
+			c3 = zero;
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+			_mm_storeu_ps(m[0].v[2].v, c0);
+			_mm_storeu_ps(m[1].v[2].v, c1);
+			_mm_storeu_ps(m[2].v[2].v, c2);
+			_mm_storeu_ps(m[3].v[2].v, c3);
+
+			c0 = _mm_loadu_ps(block->translation[0]);
+			c1 = _mm_loadu_ps(block->translation[1]);
+			c2 = _mm_loadu_ps(block->translation[2]);
+			c3 = one;
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+			_mm_storeu_ps(m[0].v[3].v, c0);
+			_mm_storeu_ps(m[1].v[3].v, c1);
+			_mm_storeu_ps(m[2].v[3].v, c2);
+			_mm_storeu_ps(m[3].v[3].v, c3);
+
+			// copy out partial block
+			if (n < a3poseBlock_size)
+				for (j = 0; j < n; ++j)
+					matrices_out[i + j] = tmp[j];
+		}
+		return count;
+	}
+	return -1;
+#else	// !A3_SPATIALPOSE_SSE
+	return a3spatialPoseConvertBatchScalar(matrices_out, spatialPoses_in, count);
+#endif	// A3_SPATIALPOSE_SSE
+}
+
+
+//-----------------------------------------------------------------------------
+
+// scalar reference for batch restore
+a3i32 a3spatialPoseRestoreBatchScalar(a3_SpatialPoseBlock *spatialPoses_out, const a3mat4 *matrices_in, const a3ui32 count)
+{
+	if (spatialPoses_out && matrices_in)
+	{
+		const a3ui32 total = a3spatialPoseBlockGetCount(count) * a3poseBlock_size;
+		a3_SpatialPose pose[1];
+		a3_SpatialPoseBlock *block;
+		a3ui32 i, j, k;
+		for (i = 0; i < total; ++i)
+		{
+			if (i < count)
+				a3spatialPoseRestore(pose, matrices_in + i);
+			else
+				a3spatialPoseReset(pose);
+			block = spatialPoses_out + i / a3poseBlock_size;
+			j = i % a3poseBlock_size;
+			for (k = 0; k < 4; ++k)
+				block->orientation[k][j] = pose->orientation.v[k];
+			for (k = 0; k < 3; ++k)
+			{
+				block->scale[k][j] = pose->scale.v[k];
+				block->translation[k][j] = pose->translation.v[k];
+			}
+		}
+		return count;
+	}
+	return -1;
+}
+
+#ifdef A3_SPATIALPOSE_SSE
+// pick one of four values per lane by mutually exclusive masks
+inline __m128 a3spatialPoseInternalPick4(const __m128 m0, const __m128 m1, const __m128 m2, const __m128 m3, const __m128 v0, const __m128 v1, const __m128 v2, const __m128 v3)
+{
+	return _mm_or_ps(_mm_or_ps(_mm_and_ps(m0, v0), _mm_and_ps(m1, v1)), _mm_or_ps(_mm_and_ps(m2, v2), _mm_and_ps(m3, v3)));
+}
+#endif	// A3_SPATIALPOSE_SSE
+
+// restore a batch of poses from matrices
+a3i32 a3spatialPoseRestoreBatch(a3_SpatialPoseBlock *spatialPoses_out, const a3mat4 *matrices_in, const a3ui32 count)
+{
+#ifdef A3_SPATIALPOSE_SSE
+	if (spatialPoses_out && matrices_in)
+	{
+		const __m128 one = _mm_set1_ps(a3real_one), half = _mm_set1_ps(a3real_half), zero = _mm_setzero_ps();
+		const __m128 signBit = _mm_set1_ps(-0.0f);
+		const a3mat4 *m = matrices_in;
+		a3_SpatialPoseBlock *block = spatialPoses_out;
+		a3mat4 tmp[a3poseBlock_size];
+		__m128 m00, m01, m02, m10, m11, m12, m20, m21, m22, t0, t1, t2, t3;
+		__m128 sx, sy, sz, isx, isy, isz, r00, r11, r22, x, y, z, w, len;
+		__m128 tw, tx, ty, tz, selW, selX, selY, selZ, root, sc, dx, dy, dz, sxy, szx, syz;
+		a3ui32 i, j, n;
+		for (i = 0; i < count; i += a3poseBlock_size, ++block, m += a3poseBlock_size)
+		{
+			// pad partial block with identity
+			n = a3minimum(count - i, a3poseBlock_size);
+			if (n < a3poseBlock_size)
+			{
+				for (j = 0; j < a3poseBlock_size; ++j)
+					if (j < n)
+						tmp[j] = m[j];
+					else
+						a3real4x4SetIdentity(tmp[j].m);
+				m = tmp;
+			}
+
+			// transpose columns so each register holds one element for all 
+			//	four matrices
+			m00 = _mm_loadu_ps(m[0].v[0].v);
+			m01 = _mm_loadu_ps(m[1].v[0].v);
+			m02 = _mm_loadu_ps(m[2].v[0].v);
+			t3 = _mm_loadu_ps(m[3].v[0].v);
+			_MM_TRANSPOSE4_PS(m00, m01, m02, t3);
+			m10 = _mm_loadu_ps(m[0].v[1].v);
+			m11 = _mm_loadu_ps(m[1].v[1].v);
+			m12 = _mm_loadu_ps(m[2].v[1].v);
+			t3 = _mm_loadu_ps(m[3].v[1].v);
+			_MM_TRANSPOSE4_PS(m10, m11, m12, t3);
+			m20 = _mm_loadu_ps(m[0].v[2].v);
+			m21 = _mm_loadu_ps(m[1].v[2].v);
+			m22 = _mm_loadu_ps(m[2].v[2].v);
+			t3 = _mm_loadu_ps(m[3].v[2].v);
+			_MM_TRANSPOSE4_PS(m20, m21, m22, t3);
+			t0 = _mm_loadu_ps(m[0].v[3].v);
+			t1 = _mm_loadu_ps(m[1].v[3].v);
+			t2 = _mm_loadu_ps(m[2].v[3].v);
+			t3 = _mm_loadu_ps(m[3].v[3].v);
+			_MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+			_mm_storeu_ps(block->translation[0], t0);
+			_mm_storeu_ps(block->translation[1], t1);
+			_mm_storeu_ps(block->translation[2], t2);
+
+			// scale is the length of each basis column
+			sx = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, m00), _mm_mul_ps(m01, m01)), _mm_mul_ps(m02, m02)));
+			sy = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, m10), _mm_mul_ps(m11, m11)), _mm_mul_ps(m12, m12)));
+			sz = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, m20), _mm_mul_ps(m21, m21)), _mm_mul_ps(m22, m22)));
+			isx = _mm_and_ps(_mm_cmpgt_ps(sx, zero), _mm_div_ps(one, sx));
+			isy = _mm_and_ps(_mm_cmpgt_ps(sy, zero), _mm_div_ps(one, sy));
+			isz = _mm_and_ps(_mm_cmpgt_ps(sz, zero), _mm_div_ps(one, sz));
+			_mm_storeu_ps(block->scale[0], sx);
+			_mm_storeu_ps(block->scale[1], sy);
+			_mm_storeu_ps(block->scale[2], sz);
+
+			// quaternion from rotation as in the single restore: each lane 
+			//	selects its largest component's case instead of branching
+			r00 = _mm_mul_ps(m00, isx);
+			r11 = _mm_mul_ps(m11, isy);
+			r22 = _mm_mul_ps(m22, isz);
+			tw = _mm_add_ps(_mm_add_ps(_mm_add_ps(one, r00), r11), r22);
+			tx = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(one, r00), r11), r22);
+			ty = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(one, r00), r11), r22);
+			tz = _mm_add_ps(_mm_sub_ps(_mm_sub_ps(one, r00), r11), r22);
+			selW = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(tw, tx), _mm_cmpge_ps(tw, ty)), _mm_cmpge_ps(tw, tz));
+			selX = _mm_andnot_ps(selW, _mm_and_ps(_mm_cmpge_ps(tx, ty), _mm_cmpge_ps(tx, tz)));
+			selY = _mm_andnot_ps(_mm_or_ps(selW, selX), _mm_cmpge_ps(ty, tz));
+			selZ = _mm_andnot_ps(_mm_or_ps(_mm_or_ps(selW, selX), selY), _mm_cmpeq_ps(zero, zero));
+			root = _mm_sqrt_ps(a3spatialPoseInternalPick4(selW, selX, selY, selZ, tw, tx, ty, tz));
+			sc = _mm_div_ps(half, root);
+			root = _mm_mul_ps(root, half);
+
+			// off-diagonal differences and sums
+			dx = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(m12, isy), _mm_mul_ps(m21, isz)), sc);
+			dy = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(m20, isz), _mm_mul_ps(m02, isx)), sc);
+			dz = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(m01, isx), _mm_mul_ps(m10, isy)), sc);
+			sxy = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(m01, isx), _mm_mul_ps(m10, isy)), sc);
+			szx = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(m20, isz), _mm_mul_ps(m02, isx)), sc);
+			syz = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(m12, isy), _mm_mul_ps(m21, isz)), sc);
+			w = a3spatialPoseInternalPick4(selW, selX, selY, selZ, root, dx, dy, dz);
+			x = a3spatialPoseInternalPick4(selW, selX, selY, selZ, dx, root, sxy, szx);
+			y = a3spatialPoseInternalPick4(selW, selX, selY, selZ, dy, sxy, root, syz);
+			z = a3spatialPoseInternalPick4(selW, selX, selY, selZ, dz, szx, syz, root);
+
+			// keep w non-negative
+			t3 = _mm_and_ps(signBit, w);
+			x = _mm_xor_ps(x, t3);
+			y = _mm_xor_ps(y, t3);
+			z = _mm_xor_ps(z, t3);
+			w = _mm_xor_ps(w, t3);
+			len = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)), _mm_mul_ps(w, w))));
+			_mm_storeu_ps(block->orientation[0], _mm_mul_ps(x, len));
+			_mm_storeu_ps(block->orientation[1], _mm_mul_ps(y, len));
+			_mm_storeu_ps(block->orientation[2], _mm_mul_ps(z, len));
+			_mm_storeu_ps(block->orientation[3], _mm_mul_ps(w, len));
+		}
+		return count;
+	}
+	return -1;
+#else	// !A3_SPATIALPOSE_SSE
+	return a3spatialPoseRestoreBatchScalar(spatialPoses_out, matrices_in, count);
+#endif	// A3_SPATIALPOSE_SSE
+}
+
 
 //-----------------------------------------------------------------------------
 
+#ifdef A3_SPATIALPOSE_SSE
+// half to float for four lanes; same steps as the scalar version
+inline __m128 a3spatialPoseInternalDecodeHalf4(const __m128i value)
+{
+	const __m128i maskExpMant = _mm_set1_epi32(0x7fff), maskSign = _mm_set1_epi32(0x8000);
+	const __m128i infNan = _mm_set1_epi32(0x7bff), expInfNan = _mm_set1_epi32(0x7f800000);
+	const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(0x77800000));
+	const __m128i expMant = _mm_and_si128(value, maskExpMant);
+	__m128 result = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMant, 13)), magic);
+	result = _mm_or_ps(result, _mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(expMant, infNan), expInfNan)));
+	return _mm_or_ps(result, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(value, maskSign), 16)));
+}
+
+// select per lane
+inline __m128 a3spatialPoseInternalSelect4(const __m128i mask, const __m128 a, const __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(mask), a), _mm_andnot_ps(_mm_castsi128_ps(mask), b));
+}
+#endif	// A3_SPATIALPOSE_SSE
+
+// decode a batch of compact poses
+a3i32 a3spatialPoseDecodeBatch(a3_SpatialPoseBlock *spatialPoses_out, const a3_SpatialPoseCompact *spatialPoses_in, const a3ui32 count)
+{
+	if (spatialPoses_out && spatialPoses_in)
+	{
+#ifdef A3_SPATIALPOSE_SSE
+		const __m128i zero = _mm_setzero_si128(), mask15 = _mm_set1_epi32(0x7fff);
+		const __m128i idx0 = _mm_setzero_si128(), idx1 = _mm_set1_epi32(1), idx2 = _mm_set1_epi32(2), idx3 = _mm_set1_epi32(3);
+		const __m128 one = _mm_set1_ps(a3real_one), two = _mm_set1_ps(a3real_two), fzero = _mm_setzero_ps();
+		const __m128 scale = _mm_set1_ps(a3real_one / (a3real)a3spatialPoseInternalQuantMax);
+		const __m128 range = _mm_set1_ps(a3real_one / a3spatialPoseInternalQuantRange);
+		const a3_SpatialPoseCompact *p = spatialPoses_in;
+		a3_SpatialPoseBlock *block = spatialPoses_out;
+		a3_SpatialPoseCompact tmp[a3poseBlock_size];
+		a3_SpatialPose identity[1];
+		__m128i r0, r1, r2, r3, lo01, lo23, hi01, hi23, o01, o2t0, t12, s, largest;
+		__m128 a, b, c, d;
+		a3ui32 i, j, n;
+		a3spatialPoseReset(identity);
+		for (i = 0; i < count; i += a3poseBlock_size, ++block, p += a3poseBlock_size)
+		{
+			// pad partial block with identity
+			n = a3minimum(count - i, a3poseBlock_size);
+			if (n < a3poseBlock_size)
+			{
+				for (j = 0; j < a3poseBlock_size; ++j)
+					if (j < n)
+						tmp[j] = p[j];
+					else
+						a3spatialPoseEncode(tmp + j, identity);
+				p = tmp;
+			}
+
+			// transpose 16-bit fields so each register holds one field for 
+			//	all four poses, widened to 32 bits
+			r0 = _mm_loadu_si128((const __m128i *)(p + 0));
+			r1 = _mm_loadu_si128((const __m128i *)(p + 1));
+			r2 = _mm_loadu_si128((const __m128i *)(p + 2));
+			r3 = _mm_loadu_si128((const __m128i *)(p + 3));
+			lo01 = _mm_unpacklo_epi16(r0, r1);
+			lo23 = _mm_unpacklo_epi16(r2, r3);
+			hi01 = _mm_unpackhi_epi16(r0, r1);
+			hi23 = _mm_unpackhi_epi16(r2, r3);
+			o01 = _mm_unpacklo_epi32(lo01, lo23);
+			o2t0 = _mm_unpackhi_epi32(lo01, lo23);
+			t12 = _mm_unpacklo_epi32(hi01, hi23);
+			s = _mm_unpackhi_epi32(hi01, hi23);
+			r0 = _mm_unpacklo_epi16(o01, zero);
+			r1 = _mm_unpackhi_epi16(o01, zero);
+			r2 = _mm_unpacklo_epi16(o2t0, zero);
+
+			// translation and scale
+			_mm_storeu_ps(block->translation[0], a3spatialPoseInternalDecodeHalf4(_mm_unpackhi_epi16(o2t0, zero)));
+			_mm_storeu_ps(block->translation[1], a3spatialPoseInternalDecodeHalf4(_mm_unpacklo_epi16(t12, zero)));
+			_mm_storeu_ps(block->translation[2], a3spatialPoseInternalDecodeHalf4(_mm_unpackhi_epi16(t12, zero)));
+			a = a3spatialPoseInternalDecodeHalf4(_mm_unpacklo_epi16(s, zero));
+			_mm_storeu_ps(block->scale[0], a);
+			_mm_storeu_ps(block->scale[1], a);
+			_mm_storeu_ps(block->scale[2], a);
+
+			// smallest three and reconstructed largest
+			largest = _mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(r0, 15), 1), _mm_srli_epi32(r1, 15));
+			a = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(r0, mask15)), scale), two), one), range);
+			b = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(r1, mask15)), scale), two), one), range);
+			c = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(r2, mask15)), scale), two), one), range);
+			d = _mm_sqrt_ps(_mm_max_ps(fzero, _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(one, _mm_mul_ps(a, a)), _mm_mul_ps(b, b)), _mm_mul_ps(c, c))));
+
+			// place components by dropped index
+			_mm_storeu_ps(block->orientation[0], a3spatialPoseInternalSelect4(_mm_cmpeq_epi32(largest, idx0), d, a));
+			_mm_storeu_ps(block->orientation[1], a3spatialPoseInternalSelect4(_mm_cmpeq_epi32(largest, idx0), a,
+				a3spatialPoseInternalSelect4(_mm_cmpeq_epi32(largest, idx1), d, b)));
+			_mm_storeu_ps(block->orientation[2], a3spatialPoseInternalSelect4(_mm_cmplt_epi32(largest, idx2), b,
+				a3spatialPoseInternalSelect4(_mm_cmpeq_epi32(largest, idx2), d, c)));
+			_mm_storeu_ps(block->orientation[3], a3spatialPoseInternalSelect4(_mm_cmpeq_epi32(largest, idx3), d, c));
+		}
+#else	// !A3_SPATIALPOSE_SSE
+		const a3ui32 total = a3spatialPoseBlockGetCount(count) * a3poseBlock_size;
+		a3_SpatialPose pose[1];
+		a3_SpatialPoseBlock *block;
+		a3ui32 i, j, k;
+		for (i = 0; i < total; ++i)
+		{
+			if (i < count)
+				a3spatialPoseDecode(pose, spatialPoses_in + i);
+			else
+				a3spatialPoseReset(pose);
+			block = spatialPoses_out + i / a3poseBlock_size;
+			j = i % a3poseBlock_size;
+			for (k = 0; k < 4; ++k)
+				block->orientation[k][j] = pose->orientation.v[k];
+			for (k = 0; k < 3; ++k)
+			{
+				block->scale[k][j] = pose->scale.v[k];
+				block->translation[k][j] = pose->translation.v[k];
+			}
+		}
+#endif	// A3_SPATIALPOSE_SSE
+		return count;
+	}
+	return -1;
+}
 
 
 //-----------------------------------------------------------------------------
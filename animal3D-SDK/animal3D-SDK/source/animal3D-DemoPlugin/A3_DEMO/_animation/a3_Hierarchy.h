@@ -21,6 +21,8 @@
 	a3_Hierarchy.h
 	Node tree structure forming a hierarchy. Nodes belonging to the same 
 		hierarchy know the index of their parent node, but not child nodes.
+		Topology (parent indices) is stored apart from node names so that 
+		traversal only touches the compact index array.
 
 	**DO NOT MODIFY THIS FILE**
 */
@@ -50,26 +52,46 @@ enum a3_HierarchyNodeNameSize
 	a3node_nameSize = 32
 };
 
+// A3: Node count limit; parent indices are stored as 16-bit integers.
+enum a3_HierarchyNodeCountMax
+{
+	a3node_countMax = 32767
+};
 
-// A3: Hierarchy node, a single link in a hierarchy tree.
+// A3: Number of detail levels; level 0 is full detail.
+enum a3_HierarchyNodeLODMax
+{
+	a3node_lodMax = 4
+};
+
+
+// A3: Hierarchy node, a single link in a hierarchy tree; cold metadata only, 
+//		the parent index lives in the hierarchy's topology array.
 //	member name: name of node (defaults to a3node_[index])
 //	member index: index of node in hierarchy
-//	member parentIndex: index of parent in hierarchy (-1 if root)
+//	member maxLOD: coarsest detail level at which node is still evaluated 
+//		(defaults to a3node_lodMax - 1, always evaluated)
 struct a3_HierarchyNode
 {
 	a3byte name[a3node_nameSize];
 	a3i32 index;
-	a3i32 parentIndex;
+	a3i32 maxLOD;
 };
 
 
 // A3: Hierarchy node container, the hierarchy itself.
-//	member nodes: array of nodes (null if unused)
+//	member parentIndex: array of parent indices, one per node (-1 if root); 
+//		this is the hot data used by traversal (null if unused)
+//	member nodes: array of node metadata (null if unused)
 //	member numNodes: maximum number of nodes in hierarchy (zero if unused)
+//	member lodNodeCount: number of leading nodes evaluated at each detail 
+//		level; nodes are contiguous per level after LOD reordering
 struct a3_Hierarchy
 {
+	a3i16 *parentIndex;
 	a3_HierarchyNode *nodes;
 	a3ui32 numNodes;
+	a3ui32 lodNodeCount[a3node_lodMax];
 };
 
 
@@ -77,7 +99,7 @@ struct a3_Hierarchy
 
 // A3: Allocate hierarchy with maximum node count, names optional.
 //	param hierarchy_out: non-null pointer to uninitialized hierarchy
-//	param numNodes: non-zero node count to initialize
+//	param numNodes: non-zero node count to initialize, at most a3node_countMax
 //	param names_opt: optional pointer to a list of names to set immediately
 //	return: numNodes if success
 //	return: -1 if invalid params
@@ -93,6 +115,27 @@ a3ret a3hierarchyCreate(a3_Hierarchy *hierarchy_out, const a3ui32 numNodes, cons
 //	return: -1 if invalid params
 a3ret a3hierarchySetNode(const a3_Hierarchy *hierarchy, const a3ui32 index, const a3i32 parentIndex, const a3byte name[a3node_nameSize]);
 
+// A3: Set the coarsest detail level at which a node is still evaluated; 
+//		takes effect after reordering.
+//	param hierarchy: non-null pointer to initialized hierarchy
+//	param index: non-negative index of node in hierarchy
+//	param maxLOD: detail level in [0, a3node_lodMax)
+//	return: index if success
+//	return: -1 if invalid params
+a3ret a3hierarchySetNodeLOD(const a3_Hierarchy *hierarchy, const a3ui32 index, const a3ui32 maxLOD);
+
+// A3: Reorder nodes by detail level so that the nodes evaluated at each 
+//		level form a contiguous range at the start of the hierarchy; 
+//		parents still precede children. A node never outlives its parent, 
+//		so each node's level is clamped to its parent's. Any data indexed 
+//		by node (e.g. poses) must be permuted using the remap.
+//	param hierarchy: non-null pointer to initialized hierarchy
+//	param remap_out_opt: optional array with one entry per node to receive 
+//		the new index of each node, indexed by old index
+//	return: number of nodes evaluated at the coarsest level if success
+//	return: -1 if invalid params
+a3ret a3hierarchyReorderLOD(a3_Hierarchy *hierarchy, a3i32 remap_out_opt[]);
+
 // A3: Get node index by name.
 //	param hierarchy: non-null pointer to initialized hierarchy
 //	param name: name to search for in hierarchy
@@ -149,7 +192,7 @@ a3ret a3hierarchyIsAncestorNode(const a3_Hierarchy *hierarchy, const a3ui32 ance
 //	return: -1 if invalid params
 a3ret a3hierarchyIsDescendantNode(const a3_Hierarchy *hierarchy, const a3ui32 descendantIndex, const a3ui32 otherIndex);
 
-// A3: Save hierarchy to binary file.
+// A3: Save hierarchy to binary file; topology is written before names.
 //	param hierarchy: non-null pointer to initialized hierarchy
 //	param fileStream: non-null pointer to file stream opened in write mode
 //	return: number of bytes written if success
@@ -165,7 +208,7 @@ a3ret a3hierarchySaveBinary(const a3_Hierarchy *hierarchy, const a3_FileStream *
 //	return: -1 if invalid params
 a3ret a3hierarchyLoadBinary(a3_Hierarchy *hierarchy, const a3_FileStream *fileStream);
 
-// A3: Store hierarchy in string.
+// A3: Store hierarchy in string; topology is written before names.
 //	param hierarchy: non-null pointer to initialized hierarchy
 //	param str: non-null byte array to stream into
 //	return: number of bytes copied if success
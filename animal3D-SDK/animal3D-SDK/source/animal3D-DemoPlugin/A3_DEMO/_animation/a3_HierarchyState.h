@@ -40,14 +40,40 @@ extern "C"
 {
 #else	// !__cplusplus
 typedef struct a3_HierarchyPose			a3_HierarchyPose;
+typedef struct a3_HierarchyPoseDQ		a3_HierarchyPoseDQ;
 typedef struct a3_HierarchyTransform	a3_HierarchyTransform;
 typedef struct a3_HierarchyPoseGroup	a3_HierarchyPoseGroup;
 typedef struct a3_HierarchyState		a3_HierarchyState;
+typedef struct a3_HierarchyJointLimits	a3_HierarchyJointLimits;
+typedef enum a3_HierarchyStateDirtyFlag	a3_HierarchyStateDirtyFlag;
+typedef enum a3_HierarchyStateScaleMode	a3_HierarchyStateScaleMode;
 #endif	// __cplusplus
 	
 
 //-----------------------------------------------------------------------------
 
+// per-node flags describing which results are out of date
+// marking a node dirty also marks its whole subtree
+enum a3_HierarchyStateDirtyFlag
+{
+	a3hierarchyStateDirty_none,							// node is up to date
+	a3hierarchyStateDirty_object = 0x01,				// object-space matrix (FK)
+	a3hierarchyStateDirty_objectInverse = 0x02,			// object-space inverse
+	a3hierarchyStateDirty_objectBindToCurrent = 0x04,	// bind-to-current (skinning)
+	a3hierarchyStateDirty_objectPose = 0x08,			// object-space pose (pose FK)
+	a3hierarchyStateDirty_all = 0x0f,
+};
+
+// kind of scale present in a state's object-space matrices; selects the 
+//	cheapest inverse that is still exact
+enum a3_HierarchyStateScaleMode
+{
+	a3hierarchyStateScale_none,		// rigid transforms only
+	a3hierarchyStateScale_uniform,	// uniform scale
+	a3hierarchyStateScale_full,		// non-uniform scale
+};
+
+
 // single pose for a collection of nodes
 // makes algorithms easier to keep this as a separate data type
 struct a3_HierarchyPose
@@ -56,6 +82,14 @@ struct a3_HierarchyPose
 };
 
 
+// single rigid pose for a collection of nodes as dual quaternions; an 
+//	alternative to matrices for FK, blending and skinning
+struct a3_HierarchyPoseDQ
+{
+	a3_SpatialPoseDQ *spatialPose;
+};
+
+
 // collection of matrices for transformation set
 struct a3_HierarchyTransform
 {
@@ -68,15 +102,93 @@ struct a3_HierarchyPoseGroup
 {
 	// pointer to hierarchy
 	const a3_Hierarchy *hierarchy;
+
+	// hierarchy poses, each referencing one contiguous run of the pool; 
+	//	if compressed, only the base pose (index 0) is set and the rest are 
+	//	null, so readers must check compactPosePool or use GetPose
+	a3_HierarchyPose *hpose;
+
+	// all spatial poses, grouped by hierarchy pose then node; once the 
+	//	group is compressed only the base pose (index 0) remains here
+	a3_SpatialPose *spatialPosePool;
+
+	// channels in use by each node (defaults to all)
+	a3_SpatialPoseChannel *channel;
+
+	// all spatial poses in compact form, same order (null if not compressed)
+	a3_SpatialPoseCompact *compactPosePool;
+
+	// number of hierarchy poses
+	a3ui32 hposeCount;
 };
 
 
 // hierarchy state structure, with a pointer to the source pose group 
 //	and transformations for kinematics
+// all arrays below are carved from one aligned block and have one entry 
+//	per node, so every update is a straight loop over contiguous memory
 struct a3_HierarchyState
 {
 	// pointer to pose set that the poses come from
 	const a3_HierarchyPoseGroup *poseGroup;
+
+	// sampled local pose
+	a3_HierarchyPose samplePose[1];
+
+	// last two evaluated local poses (previous, current); when updates are 
+	//	throttled the sampled pose is interpolated between these
+	a3_HierarchyPose evaluatedPose[2];
+
+	// object-space poses (result of pose-space forward kinematics)
+	a3_HierarchyPose objectPose[1];
+
+	// local-space matrices (converted from sampled pose)
+	a3_HierarchyTransform localSpace[1];
+
+	// object-space matrices (result of forward kinematics)
+	a3_HierarchyTransform objectSpace[1];
+
+	// inverse object-space matrices
+	a3_HierarchyTransform objectSpaceInverse[1];
+
+	// bind-to-current matrices (skinning)
+	a3_HierarchyTransform objectSpaceBindToCurrent[1];
+
+	// dirty flags per node (see a3_HierarchyStateDirtyFlag)
+	a3ubyte *nodeDirty;
+
+	// current detail level; only the first hierarchy->lodNodeCount[lod] 
+	//	nodes are evaluated, the rest hold their bind pose
+	a3ui32 lod;
+
+	// scale present in object-space matrices (defaults to full)
+	a3_HierarchyStateScaleMode scaleMode;
+
+	// seconds between evaluations (zero to evaluate every update) and 
+	//	time accumulated since the last evaluation; only sampling is 
+	//	throttled, the interpolated pose still goes through FK every update
+	a3real updateInterval, updateTime;
+
+	// raw allocation holding all of the above
+	void *data;
+};
+
+
+// per-node joint limits as swing-twist constraints on local orientation: 
+//	twist is rotation about the local x axis, swing is the remaining 
+//	rotation tilting the x axis away from rest, limited to a cone
+// limits are stored as sine and cosine of half angles in one array per 
+//	value, so the clamp pass is a straight loop over contiguous memory
+struct a3_HierarchyJointLimits
+{
+	// hierarchy the limits belong to
+	const a3_Hierarchy *hierarchy;
+
+	// half-angle sine and cosine of minimum and maximum twist
+	a3real *twistMinSin, *twistMinCos, *twistMaxSin, *twistMaxCos;
+
+	// half-angle sine and cosine of swing cone angle
+	a3real *swingMaxSin, *swingMaxCos;
 };
 	
 
@@ -88,6 +200,16 @@ a3i32 a3hierarchyPoseGroupCreate(a3_HierarchyPoseGroup *poseGroup_out, const a3_
 // release pose set
 a3i32 a3hierarchyPoseGroupRelease(a3_HierarchyPoseGroup *poseGroup);
 
+// compress pose group: all poses are stored in compact form and the full 
+//	poses are released, except for the base pose (index 0); afterwards only 
+//	hpose[0] points at data, so read other poses with GetPose
+//	returns -1 without changes if any pose has non-uniform scale, which the 
+//	compact form cannot hold
+a3i32 a3hierarchyPoseGroupCompress(a3_HierarchyPoseGroup *poseGroup);
+
+// get a full hierarchy pose from a group, decoding if compressed
+a3i32 a3hierarchyPoseGroupGetPose(const a3_HierarchyPose *pose_out, const a3_HierarchyPoseGroup *poseGroup, const a3ui32 poseIndex);
+
 // get offset to hierarchy pose in contiguous set
 a3i32 a3hierarchyPoseGroupGetPoseOffsetIndex(const a3_HierarchyPoseGroup *poseGroup, const a3ui32 poseIndex);
 
@@ -95,6 +217,55 @@ a3i32 a3hierarchyPoseGroupGetPoseOffsetIndex(const a3_HierarchyPoseGroup *poseGr
 a3i32 a3hierarchyPoseGroupGetNodePoseOffsetIndex(const a3_HierarchyPoseGroup *poseGroup, const a3ui32 poseIndex, const a3ui32 nodeIndex);
 
 
+//-----------------------------------------------------------------------------
+
+// reset full hierarchy pose
+a3i32 a3hierarchyPoseReset(const a3_HierarchyPose *pose_inout, const a3ui32 nodeCount);
+
+// copy full hierarchy pose
+a3i32 a3hierarchyPoseCopy(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount);
+
+// convert full hierarchy pose to hierarchy transforms
+a3i32 a3hierarchyPoseConvert(const a3_HierarchyTransform *transform_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount);
+
+// concatenate full hierarchy poses
+a3i32 a3hierarchyPoseConcat(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_lhs, const a3_HierarchyPose *pose_rhs, const a3ui32 nodeCount, const a3_SpatialPoseChannel *channel);
+
+// interpolate full hierarchy poses
+a3i32 a3hierarchyPoseLerp(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose0, const a3_HierarchyPose *pose1, const a3ui32 nodeCount, const a3real u, const a3_SpatialPoseChannel *channel);
+
+
+// set full dual quaternion pose from hierarchy pose (scale is dropped)
+a3i32 a3hierarchyPoseDQSetPose(const a3_HierarchyPoseDQ *pose_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount);
+
+// convert full dual quaternion pose to hierarchy transforms
+a3i32 a3hierarchyPoseDQConvert(const a3_HierarchyTransform *transform_out, const a3_HierarchyPoseDQ *pose_in, const a3ui32 nodeCount);
+
+// interpolate full dual quaternion poses
+a3i32 a3hierarchyPoseDQLerp(const a3_HierarchyPoseDQ *pose_out, const a3_HierarchyPoseDQ *pose0, const a3_HierarchyPoseDQ *pose1, const a3ui32 nodeCount, const a3real u);
+
+// calculate bind-to-current dual quaternions for skinning given object-space 
+//	poses and inverse bind-pose object-space poses
+a3i32 a3hierarchyPoseDQGetBindToCurrent(const a3_HierarchyPoseDQ *pose_out, const a3_HierarchyPoseDQ *objectPose, const a3_HierarchyPoseDQ *objectBindInverse, const a3ui32 nodeCount);
+
+
+//-----------------------------------------------------------------------------
+
+// create joint limits for hierarchy; all nodes start unlimited
+a3i32 a3hierarchyJointLimitsCreate(a3_HierarchyJointLimits *limits_out, const a3_Hierarchy *hierarchy);
+
+// release joint limits
+a3i32 a3hierarchyJointLimitsRelease(a3_HierarchyJointLimits *limits);
+
+// set limits for a node in degrees: twist range within (-180, 180) and 
+//	swing cone angle within [0, 180]
+a3i32 a3hierarchyJointLimitsSetNode(const a3_HierarchyJointLimits *limits, const a3ui32 index, const a3real twistMin, const a3real twistMax, const a3real swingMax);
+
+// clamp orientations of hierarchy pose to joint limits; nodes within 
+//	limits are left untouched; returns number of nodes clamped
+a3i32 a3hierarchyPoseApplyLimits(const a3_HierarchyPose *pose_inout, const a3_HierarchyJointLimits *limits, const a3ui32 nodeCount);
+
+
 //-----------------------------------------------------------------------------
 
 // initialize hierarchy state given an initialized hierarchy
@@ -103,10 +274,59 @@ a3i32 a3hierarchyStateCreate(a3_HierarchyState *state_out, const a3_HierarchyPos
 // release hierarchy state
 a3i32 a3hierarchyStateRelease(a3_HierarchyState *state);
 
-// update inverse object-space matrices
-a3i32 a3hierarchyStateUpdateObjectInverse(const a3_HierarchyState *state, const a3boolean usingScale);
+// set detail level; nodes dropped by the change are reset to the bind pose
+a3i32 a3hierarchyStateSetLOD(a3_HierarchyState *state, const a3ui32 lod);
+
+// get number of nodes evaluated at the current detail level
+a3i32 a3hierarchyStateGetActiveNodeCount(const a3_HierarchyState *state);
+
+// set scale mode used to pick matrix inverses
+a3i32 a3hierarchyStateSetScaleMode(a3_HierarchyState *state, const a3_HierarchyStateScaleMode scaleMode);
+
+// set evaluation rate in updates per second (zero to evaluate every update); 
+//	phase in [0, 1) offsets the first evaluation so that states sharing a 
+//	rate do not all evaluate on the same update
+// only sampling (e.g. blend tree evaluation) runs at this rate; skipped 
+//	updates interpolate the sampled pose, and conversion, FK, inverse and 
+//	skinning still run every update, so the saving is in proportion to 
+//	the share of sampling in the update: worthwhile for blend trees, none 
+//	for a single keyframe lerp, which costs the same as the interpolation
+a3i32 a3hierarchyStateSetUpdateRate(a3_HierarchyState *state, const a3real rate, const a3real phase);
+
+// choose an evaluation rate from a measure of screen coverage or importance 
+//	in [0, 1], stepping down from the full rate in whole divisions
+a3real a3hierarchyStateGetUpdateRateForCoverage(const a3real coverage, const a3real rateFull);
+
+// advance update schedule; returns 1 if the state is due for evaluation, 
+//	in which case the caller samples into the sampled pose and commits it; 
+//	returns 0 if the sampled pose was interpolated instead
+a3i32 a3hierarchyStateScheduleUpdate(a3_HierarchyState *state, const a3real dt);
+
+// commit newly evaluated sampled pose to the schedule; when throttled, the 
+//	sampled pose is replaced with the interpolated pose (one interval behind)
+a3i32 a3hierarchyStateScheduleCommit(a3_HierarchyState *state);
+
+// mark node and its descendants dirty after changing its local transform
+a3i32 a3hierarchyStateMarkDirty(const a3_HierarchyState *state, const a3ui32 nodeIndex);
+
+// mark all nodes dirty
+a3i32 a3hierarchyStateMarkDirtyAll(const a3_HierarchyState *state);
+
+// clamp sampled pose of active nodes to joint limits (e.g. after IK or 
+//	blending) and mark clamped nodes dirty; returns number clamped
+a3i32 a3hierarchyStateApplyLimits(const a3_HierarchyState *state, const a3_HierarchyJointLimits *limits);
+
+// convert sampled poses of dirty nodes to local-space matrices
+a3i32 a3hierarchyStateUpdateLocalSpace(const a3_HierarchyState *state);
+
+// update inverse object-space matrices of dirty nodes, using the inverse 
+//	allowed by the state's scale mode (the same one partial IK uses for the 
+//	shared cache)
+a3i32 a3hierarchyStateUpdateObjectInverse(const a3_HierarchyState *state);
 
-// update bind-to-current given bind-pose object-space transforms
+// update bind-to-current of dirty nodes given bind-pose object-space transforms
+//	(nodes culled by detail level inherit their parent's matrix, which is 
+//	exact because they hold their bind pose)
 a3i32 a3hierarchyStateUpdateObjectBindToCurrent(const a3_HierarchyState *state, const a3_HierarchyTransform *objectSpaceBindInverse);
 
 
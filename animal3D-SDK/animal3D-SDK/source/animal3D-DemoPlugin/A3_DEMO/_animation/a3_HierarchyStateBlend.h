@@ -35,12 +35,260 @@
 extern "C"
 {
 #else	// !__cplusplus
-
+typedef enum a3_BlendTreeOp					a3_BlendTreeOp;
+typedef struct a3_BlendTreeNode				a3_BlendTreeNode;
+typedef struct a3_BlendTreeInstruction		a3_BlendTreeInstruction;
+typedef struct a3_BlendTree					a3_BlendTree;
+typedef struct a3_BlendTreeScratch			a3_BlendTreeScratch;
 #endif	// __cplusplus
 	
 
 //-----------------------------------------------------------------------------
 
+// single pose blend operations: 
+//	orientations blend as normalized weighted sums along the shorter arc 
+//	(slerp is the exception), scales and translations as weighted sums; 
+//	concatenation and negation follow a3spatialPoseConcat (quaternion 
+//	product, scale product, translation sum)
+
+// identity pose
+a3i32 a3spatialPoseOpIdentity(a3_SpatialPose *pose_out);
+
+// construct pose from components
+a3i32 a3spatialPoseOpInit(a3_SpatialPose *pose_out, const a3vec4 *orientation, const a3vec3 *scale, const a3vec3 *translation);
+
+// copy pose
+a3i32 a3spatialPoseOpCopy(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_in);
+
+// negate pose: inverse under concatenation
+a3i32 a3spatialPoseOpNegate(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_in);
+
+// concatenate poses
+a3i32 a3spatialPoseOpConcat(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_lhs, const a3_SpatialPose *pose_rhs);
+
+// interpolate poses (orientation nlerp)
+a3i32 a3spatialPoseOpLerp(a3_SpatialPose *pose_out, const a3_SpatialPose *pose0, const a3_SpatialPose *pose1, const a3real u);
+
+// interpolate poses (orientation slerp)
+a3i32 a3spatialPoseOpSlerp(a3_SpatialPose *pose_out, const a3_SpatialPose *pose0, const a3_SpatialPose *pose1, const a3real u);
+
+// scale pose: interpolate from identity
+a3i32 a3spatialPoseOpScale(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_in, const a3real u);
+
+// bilinear interpolation: u0 blends within pairs (00-01, 10-11), u1 between them
+a3i32 a3spatialPoseOpBilerp(a3_SpatialPose *pose_out, const a3_SpatialPose *pose00, const a3_SpatialPose *pose01, const a3_SpatialPose *pose10, const a3_SpatialPose *pose11, const a3real u0, const a3real u1);
+
+// triangular (barycentric) interpolation: weights 1 - u1 - u2, u1, u2
+a3i32 a3spatialPoseOpTriangular(a3_SpatialPose *pose_out, const a3_SpatialPose *pose0, const a3_SpatialPose *pose1, const a3_SpatialPose *pose2, const a3real u1, const a3real u2);
+
+// cubic (Catmull-Rom) interpolation between pose0 and pose1
+a3i32 a3spatialPoseOpCubic(a3_SpatialPose *pose_out, const a3_SpatialPose *posePrev, const a3_SpatialPose *pose0, const a3_SpatialPose *pose1, const a3_SpatialPose *poseNext, const a3real u);
+
+// additive layer: base + u * (additive - reference)
+a3i32 a3spatialPoseOpAdditive(a3_SpatialPose *pose_out, const a3_SpatialPose *pose_base, const a3_SpatialPose *pose_additive, const a3_SpatialPose *pose_reference, const a3real u);
+
+
+//-----------------------------------------------------------------------------
+
+// hierarchy pose blend operations: each applies the single pose operation 
+//	to every node in one straight loop over the pose arrays
+
+// identity hierarchy pose
+a3i32 a3hierarchyPoseOpIdentity(const a3_HierarchyPose *pose_out, const a3ui32 nodeCount);
+
+// construct every node from the same components
+a3i32 a3hierarchyPoseOpInit(const a3_HierarchyPose *pose_out, const a3ui32 nodeCount, const a3vec4 *orientation, const a3vec3 *scale, const a3vec3 *translation);
+
+// copy hierarchy pose
+a3i32 a3hierarchyPoseOpCopy(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount);
+
+// negate hierarchy pose
+a3i32 a3hierarchyPoseOpNegate(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount);
+
+// concatenate hierarchy poses
+a3i32 a3hierarchyPoseOpConcat(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_lhs, const a3_HierarchyPose *pose_rhs, const a3ui32 nodeCount);
+
+// interpolate hierarchy poses (orientation nlerp)
+a3i32 a3hierarchyPoseOpLerp(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose0, const a3_HierarchyPose *pose1, const a3ui32 nodeCount, const a3real u);
+
+// interpolate hierarchy poses (orientation slerp)
+a3i32 a3hierarchyPoseOpSlerp(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose0, const a3_HierarchyPose *pose1, const a3ui32 nodeCount, const a3real u);
+
+// scale hierarchy pose
+a3i32 a3hierarchyPoseOpScale(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_in, const a3ui32 nodeCount, const a3real u);
+
+// bilinear interpolation of hierarchy poses
+a3i32 a3hierarchyPoseOpBilerp(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose00, const a3_HierarchyPose *pose01, const a3_HierarchyPose *pose10, const a3_HierarchyPose *pose11, const a3ui32 nodeCount, const a3real u0, const a3real u1);
+
+// triangular interpolation of hierarchy poses
+a3i32 a3hierarchyPoseOpTriangular(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose0, const a3_HierarchyPose *pose1, const a3_HierarchyPose *pose2, const a3ui32 nodeCount, const a3real u1, const a3real u2);
+
+// cubic interpolation of hierarchy poses
+a3i32 a3hierarchyPoseOpCubic(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *posePrev, const a3_HierarchyPose *pose0, const a3_HierarchyPose *pose1, const a3_HierarchyPose *poseNext, const a3ui32 nodeCount, const a3real u);
+
+
+// layered blending: the weight u applies to every node, times the node's 
+//	entry in the mask if one is given; a mask is a dense array of weights 
+//	in hierarchy order, so a masked layer is still one loop over all nodes
+
+// override layer: lerp from base toward layer
+a3i32 a3hierarchyPoseOpOverride(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_base, const a3_HierarchyPose *pose_layer, const a3ui32 nodeCount, const a3real u, const a3real *mask_opt);
+
+// additive layer: base + u * (additive - reference)
+a3i32 a3hierarchyPoseOpAdditive(const a3_HierarchyPose *pose_out, const a3_HierarchyPose *pose_base, const a3_HierarchyPose *pose_additive, const a3_HierarchyPose *pose_reference, const a3ui32 nodeCount, const a3real u, const a3real *mask_opt);
+
+// set every entry of a mask
+a3i32 a3hierarchyMaskFill(a3real *mask_out, const a3ui32 nodeCount, const a3real weight);
+
+// set mask entries for a node and all of its descendants, e.g. the upper 
+//	body from the spine up: fill with 0, then set branch from spine with 1
+a3i32 a3hierarchyMaskSetBranch(a3real *mask_out, const a3_Hierarchy *hierarchy, const a3ui32 rootIndex, const a3real weight);
+
+
+//-----------------------------------------------------------------------------
+
+// blend tree: a tree of blend operations authored as nodes, compiled into 
+//	a flat list of instructions in dependency order; each instruction 
+//	writes one scratch pose from scratch poses written before it, so 
+//	evaluation is one linear loop with no recursion or allocation
+
+// blend tree constants
+enum
+{
+	a3blendTree_inputMax = 4,	// most inputs of any operation
+	a3blendTree_paramMax = 2,	// most parameters of any operation
+	a3blendTree_slotMax = 32,	// most scratch poses live at once
+};
+
+// blend tree operations; inputs and parameters used by each: 
+enum a3_BlendTreeOp
+{
+	a3blendTreeOp_identity,		// none
+	a3blendTreeOp_sample,		// key poses sample[0], sample[1] from group; param[0] blends
+	a3blendTreeOp_lerp,			// inputs 0, 1; param[0]
+	a3blendTreeOp_concat,		// inputs 0, 1
+	a3blendTreeOp_negate,		// input 0
+	a3blendTreeOp_scale,		// input 0; param[0]
+	a3blendTreeOp_bilerp,		// inputs 0-3; param[0], param[1]
+	a3blendTreeOp_triangular,	// inputs 0-2; param[0], param[1]
+	a3blendTreeOp_override,		// inputs base, layer; param[0]; mask
+	a3blendTreeOp_additive,		// inputs base, additive, reference; param[0]; mask
+	a3blendTreeOp_count
+};
+
+
+// authored blend tree node
+struct a3_BlendTreeNode
+{
+	// operation
+	a3_BlendTreeOp op;
+
+	// indices of input nodes (-1 if unused)
+	a3i32 input[a3blendTree_inputMax];
+
+	// indices into the parameter array passed at evaluation
+	a3ui32 param[a3blendTree_paramMax];
+
+	// key pose indices in the pose group (samplers only)
+	a3ui32 sample[2];
+
+	// mask for layers: 1 + index in the mask list (0 for none, so a 
+	//	zeroed node is unmasked)
+	a3ui32 mask;
+};
+
+// compiled instruction
+struct a3_BlendTreeInstruction
+{
+	// operation
+	a3ui16 op;
+
+	// scratch slot written, and scratch slots read (samplers use in[0] 
+	//	as a temporary when the pose group is compressed)
+	a3ui16 out, in[a3blendTree_inputMax];
+
+	// instructions that produce each input
+	a3ui16 source[a3blendTree_inputMax];
+
+	// parameter indices
+	a3ui16 param[a3blendTree_paramMax];
+
+	// key pose indices
+	a3ui32 sample[2];
+
+	// layer mask (null for none)
+	const a3real *mask;
+};
+
+// compiled blend tree
+struct a3_BlendTree
+{
+	// pose group that samplers read from
+	const a3_HierarchyPoseGroup *poseGroup;
+
+	// instructions in evaluation order; the last one writes the result
+	a3_BlendTreeInstruction *instruction;
+	a3ui32 instructionCount;
+
+	// scratch poses needed, and slot holding the result
+	a3ui32 slotCount, resultSlot;
+
+	// number of parameters expected at evaluation
+	a3ui32 paramCount;
+
+	// inputs whose effective weight falls below this are not evaluated, 
+	//	and blends that reduce to one input become copies (default 0.001; 
+	//	zero evaluates everything)
+	a3real cullEpsilon;
+};
+
+// evaluation scratch arena: one hierarchy pose per slot per instance, 
+//	allocated once and reused by every evaluation; poses for all 
+//	instances of a slot are adjacent (slot * instanceCount + instance)
+struct a3_BlendTreeScratch
+{
+	// scratch hierarchy poses
+	a3_HierarchyPose *slot;
+
+	// effective weight magnitude of each instruction per instance (negative if culled)
+	a3real *weight;
+
+	// number of slots, instructions, instances and nodes per slot
+	a3ui32 slotCount, instructionCount, instanceCount, nodeCount;
+
+	// counts from the last evaluation, summed over instances: instructions 
+	//	executed, instructions culled, samplers culled, blends done as copies
+	a3ui32 executeCount, cullCount, sampleSkipCount, copyCount;
+};
+
+
+// compile blend tree from authored nodes given the root node; each node 
+//	may feed only one other node; layer nodes refer to the mask list by 
+//	1-based index, and the list must outlive the tree
+a3i32 a3blendTreeCreate(a3_BlendTree *tree_out, const a3_HierarchyPoseGroup *poseGroup, const a3_BlendTreeNode *nodes, const a3ui32 nodeCount, const a3ui32 rootIndex, const a3ui32 paramCount, const a3real *const masks_opt[], const a3ui32 maskCount);
+
+// release blend tree
+a3i32 a3blendTreeRelease(a3_BlendTree *tree);
+
+// allocate scratch arena for evaluating up to instanceCount instances of a tree
+a3i32 a3blendTreeScratchCreate(a3_BlendTreeScratch *scratch_out, const a3_BlendTree *tree, const a3ui32 instanceCount);
+
+// release scratch arena
+a3i32 a3blendTreeScratchRelease(a3_BlendTreeScratch *scratch);
+
+// evaluate blend tree for the first nodeCount hierarchy nodes (e.g. the 
+//	active detail level) and copy the result to the output pose; branches 
+//	weighted below the tree's epsilon are skipped (see scratch counters)
+//	returns number of instructions executed
+a3i32 a3blendTreeEvaluate(const a3_HierarchyPose *pose_out, const a3_BlendTree *tree, a3_BlendTreeScratch *scratch, const a3real *param, const a3ui32 nodeCount);
+
+// evaluate many instances of one blend tree (e.g. a crowd), instruction by 
+//	instruction: each instruction runs for every instance before the next, 
+//	so the list is walked once and lerps run 4 instances per SIMD pass
+//	poses_out: instanceCount output poses
+//	param: instanceCount parameter blocks of tree->paramCount each
+//	returns number of instructions executed over all instances
+a3i32 a3blendTreeEvaluateMany(const a3_HierarchyPose poses_out[], const a3_BlendTree *tree, a3_BlendTreeScratch *scratch, const a3real *param, const a3ui32 instanceCount, const a3ui32 nodeCount);
 
 
 //-----------------------------------------------------------------------------
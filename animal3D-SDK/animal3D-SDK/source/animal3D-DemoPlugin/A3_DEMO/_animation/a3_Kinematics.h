@@ -35,10 +35,73 @@
 extern "C"
 {
 #else	// !__cplusplus
-
+typedef struct a3_KinematicsTwoBone		a3_KinematicsTwoBone;
+typedef struct a3_KinematicsChain		a3_KinematicsChain;
+typedef enum a3_KinematicsChainMethod	a3_KinematicsChainMethod;
 #endif	// __cplusplus
 
 
+//-----------------------------------------------------------------------------
+
+// iterative chain IK methods
+enum a3_KinematicsChainMethod
+{
+	a3kinematicsChain_fabrik,	// forward and backward reaching on positions
+	a3kinematicsChain_ccd,		// cyclic coordinate descent on rotations
+};
+
+
+// two-bone IK request, for solving many limbs at once
+struct a3_KinematicsTwoBone
+{
+	// state to solve on
+	const a3_HierarchyState *hierarchyState;
+
+	// root, mid and end nodes
+	a3ui32 rootIndex, midIndex, endIndex;
+
+	// object-space target and pole positions
+	a3vec3 target, pole;
+};
+
+
+// iterative IK chain: a contiguous node range where each node is the 
+//	parent of the next, with solver settings, warm-start cache and counters
+struct a3_KinematicsChain
+{
+	// first node and number of nodes in chain (last is the end effector)
+	a3ui32 firstIndex, nodeCount;
+
+	// method, distance from end effector to target considered solved, 
+	//	and maximum number of iterations per solve
+	a3_KinematicsChainMethod method;
+	a3real tolerance;
+	a3ui32 iterationMax;
+
+	// start from the last solution instead of the incoming pose
+	a3boolean warmStart;
+
+	// last solution is stored
+	a3boolean solutionValid;
+
+	// last solution: local orientations, one per node
+	a3vec4 *solution;
+
+	// scratch: object-space positions and bone lengths, one per node
+	a3vec3 *position;
+	a3real *length;
+
+	// counters for the last solve: iterations, remaining error, seconds
+	a3ui32 iterations;
+	a3real error;
+	a3f64 time;
+
+	// counters accumulated since last reset
+	a3ui32 solveTotal, iterationTotal;
+	a3f64 timeTotal;
+};
+
+
 //-----------------------------------------------------------------------------
 
 // general forward kinematics: 
@@ -54,6 +117,25 @@ a3i32 a3kinematicsSolveForward(const a3_HierarchyState *hierarchyState);
 // forward kinematics solver starting at a specified joint
 a3i32 a3kinematicsSolveForwardPartial(const a3_HierarchyState *hierarchyState, const a3ui32 firstIndex, const a3ui32 nodeCount);
 
+// forward kinematics solver for many states at once: states sharing a 
+//	hierarchy are solved in groups of 4, one state per SIMD lane, walking 
+//	the shared parent array once per group; results match the single-state 
+//	solver exactly; returns total number of nodes updated
+a3i32 a3kinematicsSolveForwardMany(const a3_HierarchyState *const hierarchyStates[], const a3ui32 stateCount);
+
+// forward kinematics solver working on poses instead of matrices: 
+//	object-space pose = object-space parent pose * local-space pose, 
+//	where rotations multiply, the child translation is scaled and rotated 
+//	by the parent and offset by the parent translation, and scales multiply 
+//	(exact for uniform scale); object-space matrices are converted once at 
+//	the end; nodes are updated by their own object pose dirty flag, so this 
+//	can be mixed with the matrix solvers
+a3i32 a3kinematicsSolveForwardPose(const a3_HierarchyState *hierarchyState);
+
+// forward kinematics solver for rigid dual quaternion poses: 
+//	object-space pose = object-space parent pose * local-space pose
+a3i32 a3kinematicsSolveForwardDQ(const a3_HierarchyPoseDQ *objectPose_out, const a3_HierarchyPoseDQ *localPose, const a3_Hierarchy *hierarchy);
+
 
 //-----------------------------------------------------------------------------
 
@@ -67,10 +149,52 @@ a3i32 a3kinematicsSolveForwardPartial(const a3_HierarchyState *hierarchyState, c
 // inverse kinematics solver given an initialized hierarchy state
 a3i32 a3kinematicsSolveInverse(const a3_HierarchyState *hierarchyState);
 
-// inverse kinematics solver starting at a specified joint
+// inverse kinematics solver starting at a specified joint: 
+//	object-space matrices are taken as current; a parent's cached inverse 
+//	is reused when up to date, otherwise it is recalculated with the 
+//	cheapest inverse allowed by the state's scale mode and cached
 a3i32 a3kinematicsSolveInversePartial(const a3_HierarchyState *hierarchyState, const a3ui32 firstIndex, const a3ui32 nodeCount);
 
 
+//-----------------------------------------------------------------------------
+
+// analytic two-bone inverse kinematics: 
+//	rotates root and mid nodes so that the end node reaches the target 
+//	(or points at it, if out of reach), bending in the plane containing 
+//	the pole position; the mid node must descend from the root and the end 
+//	from the mid node, all within the active detail level; object-space 
+//	matrices must be current; updates local matrices and sampled poses of 
+//	root and mid, then re-runs FK once for the root's subtree
+//	returns number of nodes updated by FK
+a3i32 a3kinematicsSolveTwoBone(const a3_HierarchyState *hierarchyState, const a3ui32 rootIndex, const a3ui32 midIndex, const a3ui32 endIndex, const a3real3p target, const a3real3p pole);
+
+// two-bone inverse kinematics for many requests: the triangle is solved 
+//	for 4 requests at once, one per SIMD lane, and their local poses are 
+//	recovered together; requests may share a state as long as no request's 
+//	chain lies inside another's subtree, and adjacent requests on the same 
+//	state share one dirty sweep and one FK pass; invalid requests are 
+//	skipped; returns number of requests solved
+a3i32 a3kinematicsSolveTwoBoneMany(const a3_KinematicsTwoBone requests[], const a3ui32 requestCount);
+
+
+// create iterative IK chain over a contiguous node range
+a3i32 a3kinematicsChainCreate(a3_KinematicsChain *chain_out, const a3_Hierarchy *hierarchy, const a3ui32 firstIndex, const a3ui32 nodeCount, const a3_KinematicsChainMethod method);
+
+// release iterative IK chain
+a3i32 a3kinematicsChainRelease(a3_KinematicsChain *chain);
+
+// reset accumulated counters (e.g. once per frame)
+a3i32 a3kinematicsChainResetCounters(a3_KinematicsChain *chain);
+
+// iterative chain IK: moves the end effector toward the target until it 
+//	is within tolerance or the iteration cap is reached; object-space 
+//	matrices must be current; updates local matrices and sampled poses of 
+//	the chain; iterations only keep the chain itself current, then FK is 
+//	run once for its subtree
+//	returns number of iterations used
+a3i32 a3kinematicsSolveChain(const a3_HierarchyState *hierarchyState, a3_KinematicsChain *chain, const a3real3p target);
+
+
 //-----------------------------------------------------------------------------
 
 
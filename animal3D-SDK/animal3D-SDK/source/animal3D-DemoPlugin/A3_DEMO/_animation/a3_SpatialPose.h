@@ -30,6 +30,18 @@ Description of a spatial pose with rotation, translation and scale.
 #include "animal3D-A3DM/animal3D-A3DM.h"
 
 
+// batch pose paths use SSE when available (real is always single precision 
+//	with the precompiled math library); define A3_SPATIALPOSE_SCALAR to 
+//	force the scalar paths
+#if (!defined A3_SPATIALPOSE_SCALAR && (defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2) || defined __SSE2__))
+#define A3_SPATIALPOSE_SSE
+#endif	// SSE
+
+#ifdef A3_SPATIALPOSE_SSE
+#include <xmmintrin.h>
+#endif	// A3_SPATIALPOSE_SSE
+
+
 //-----------------------------------------------------------------------------
 
 #ifdef __cplusplus
@@ -37,7 +49,12 @@ extern "C"
 {
 #else	// !__cplusplus
 typedef enum a3_SpatialPoseChannel		a3_SpatialPoseChannel;
+typedef enum a3_SpatialPoseEulerOrder	a3_SpatialPoseEulerOrder;
 typedef struct a3_SpatialPose			a3_SpatialPose;
+typedef struct a3_SpatialPoseEuler		a3_SpatialPoseEuler;
+typedef struct a3_SpatialPoseDQ			a3_SpatialPoseDQ;
+typedef struct a3_SpatialPoseBlock		a3_SpatialPoseBlock;
+typedef struct a3_SpatialPoseCompact	a3_SpatialPoseCompact;
 #endif	// __cplusplus
 	
 
@@ -49,20 +66,240 @@ enum a3_SpatialPoseChannel
 {
 	// identity
 	a3poseChannel_none,					// no channels
+
+	// orientation
+	a3poseChannel_orient_x = 0x0001,	// rotation about x
+	a3poseChannel_orient_y = 0x0002,	// rotation about y
+	a3poseChannel_orient_z = 0x0004,	// rotation about z
+	a3poseChannel_orient_xy = a3poseChannel_orient_x | a3poseChannel_orient_y,
+	a3poseChannel_orient_yz = a3poseChannel_orient_y | a3poseChannel_orient_z,
+	a3poseChannel_orient_zx = a3poseChannel_orient_z | a3poseChannel_orient_x,
+	a3poseChannel_orient_xyz = a3poseChannel_orient_xy | a3poseChannel_orient_z,
+
+	// scale
+	a3poseChannel_scale_x = 0x0010,		// scale along x
+	a3poseChannel_scale_y = 0x0020,		// scale along y
+	a3poseChannel_scale_z = 0x0040,		// scale along z
+	a3poseChannel_scale_xy = a3poseChannel_scale_x | a3poseChannel_scale_y,
+	a3poseChannel_scale_yz = a3poseChannel_scale_y | a3poseChannel_scale_z,
+	a3poseChannel_scale_zx = a3poseChannel_scale_z | a3poseChannel_scale_x,
+	a3poseChannel_scale_xyz = a3poseChannel_scale_xy | a3poseChannel_scale_z,
+
+	// translation
+	a3poseChannel_translate_x = 0x0100,	// translation along x
+	a3poseChannel_translate_y = 0x0200,	// translation along y
+	a3poseChannel_translate_z = 0x0400,	// translation along z
+	a3poseChannel_translate_xy = a3poseChannel_translate_x | a3poseChannel_translate_y,
+	a3poseChannel_translate_yz = a3poseChannel_translate_y | a3poseChannel_translate_z,
+	a3poseChannel_translate_zx = a3poseChannel_translate_z | a3poseChannel_translate_x,
+	a3poseChannel_translate_xyz = a3poseChannel_translate_xy | a3poseChannel_translate_z,
+
+	// everything
+	a3poseChannel_all = a3poseChannel_orient_xyz | a3poseChannel_scale_xyz | a3poseChannel_translate_xyz,
+};
+
+
+// rotation order for Euler angles; the first axis listed is applied first, 
+//	e.g. xyz is R = Rz * Ry * Rx
+enum a3_SpatialPoseEulerOrder
+{
+	a3poseEulerOrder_xyz,
+	a3poseEulerOrder_yzx,
+	a3poseEulerOrder_zxy,
+	a3poseEulerOrder_yxz,
+	a3poseEulerOrder_xzy,
+	a3poseEulerOrder_zyx,
 };
 
 	
 //-----------------------------------------------------------------------------
 
 // single pose for a single node
+// stored decomposed; the matrix is only produced on conversion
 struct a3_SpatialPose
 {
-	a3mat4 transform;
+	// orientation as unit quaternion (x, y, z, w)
+	a3vec4 orientation;
+
+	// scale along each axis
+	a3vec3 scale;
+
+	// translation
+	a3vec3 translation;
+};
+
+
+// single pose for a single node with orientation as Euler angles, as stored 
+//	by formats such as HTR; converts to a matrix directly, or to a 
+//	quaternion pose for blending
+struct a3_SpatialPoseEuler
+{
+	// rotation angles in degrees, validated to [-360, +360]
+	a3vec3 angles;
+
+	// scale along each axis
+	a3vec3 scale;
+
+	// translation
+	a3vec3 translation;
+
+	// order in which angles are applied
+	a3_SpatialPoseEulerOrder order;
+};
+
+
+// single pose for a single node as a unit dual quaternion (rigid: rotation 
+//	and translation only, 32 bytes); concatenates and blends directly, 
+//	without going through matrices
+struct a3_SpatialPoseDQ
+{
+	a3dualquat transform;
+};
+
+
+// batch size of a pose block
+enum a3_SpatialPoseBlockSize
+{
+	a3poseBlock_size = 4,
+};
+
+
+// block of spatial poses transposed for batch processing: each component 
+//	is stored for all poses in the block side by side ([component][pose])
+struct a3_SpatialPoseBlock
+{
+	// orientation quaternion components (x, y, z, w)
+	a3real orientation[4][a3poseBlock_size];
+
+	// scale components
+	a3real scale[3][a3poseBlock_size];
+
+	// translation components
+	a3real translation[3][a3poseBlock_size];
+};
+
+
+// compact single node pose for storage (16 bytes)
+//	orientation: smallest-three quaternion in 48 bits; the index of the 
+//		dropped (largest) component is split across the top bits of the 
+//		first two words, each word's low 15 bits holds one component
+//	translation: half-precision floats
+//	scale: uniform, half-precision float
+struct a3_SpatialPoseCompact
+{
+	a3ui16 orientation[3];
+	a3ui16 translation[3];
+	a3ui16 scale;
+	a3ui16 reserved;
 };
 
 
 //-----------------------------------------------------------------------------
 
+// reset single node pose
+a3i32 a3spatialPoseReset(a3_SpatialPose *spatialPose);
+
+// set orientation of single node pose from Euler angles in degrees (XYZ)
+a3i32 a3spatialPoseSetRotation(a3_SpatialPose *spatialPose, const a3real degrees_x, const a3real degrees_y, const a3real degrees_z);
+
+// set scale of single node pose
+a3i32 a3spatialPoseSetScale(a3_SpatialPose *spatialPose, const a3real scale_x, const a3real scale_y, const a3real scale_z);
+
+// set translation of single node pose
+a3i32 a3spatialPoseSetTranslation(a3_SpatialPose *spatialPose, const a3real translate_x, const a3real translate_y, const a3real translate_z);
+
+// copy single node pose
+a3i32 a3spatialPoseCopy(a3_SpatialPose *spatialPose_out, const a3_SpatialPose *spatialPose_in);
+
+// convert single node pose to matrix; every channel is converted, since 
+//	channels not in use keep their base values in the pose
+a3i32 a3spatialPoseConvert(a3mat4 *mat_out, const a3_SpatialPose *spatialPose_in);
+
+// reset single node Euler pose to identity with the given rotation order
+a3i32 a3spatialPoseEulerReset(a3_SpatialPoseEuler *spatialPose, const a3_SpatialPoseEulerOrder order);
+
+// convert single node Euler pose to matrix using a kernel for its rotation 
+//	order; every stored angle is used, so axes that are not animated keep 
+//	their rest angle, as in the quaternion path
+a3i32 a3spatialPoseEulerConvert(a3mat4 *mat_out, const a3_SpatialPoseEuler *spatialPose_in);
+
+// convert single node Euler pose to quaternion pose
+a3i32 a3spatialPoseEulerGetPose(a3_SpatialPose *spatialPose_out, const a3_SpatialPoseEuler *spatialPose_in);
+
+// reset single node dual quaternion pose
+a3i32 a3spatialPoseDQReset(a3_SpatialPoseDQ *spatialPose);
+
+// set single node dual quaternion pose from pose (scale is dropped)
+a3i32 a3spatialPoseDQSetPose(a3_SpatialPoseDQ *spatialPose_out, const a3_SpatialPose *spatialPose_in);
+
+// get single node pose from dual quaternion pose (unit scale)
+a3i32 a3spatialPoseDQGetPose(a3_SpatialPose *spatialPose_out, const a3_SpatialPoseDQ *spatialPose_in);
+
+// convert single node dual quaternion pose to matrix
+a3i32 a3spatialPoseDQConvert(a3mat4 *mat_out, const a3_SpatialPoseDQ *spatialPose_in);
+
+// concatenate single node dual quaternion poses (lhs applied after rhs)
+a3i32 a3spatialPoseDQConcat(a3_SpatialPoseDQ *spatialPose_out, const a3_SpatialPoseDQ *spatialPose_lhs, const a3_SpatialPoseDQ *spatialPose_rhs);
+
+// interpolate single node dual quaternion poses with dual linear blending
+a3i32 a3spatialPoseDQLerp(a3_SpatialPoseDQ *spatialPose_out, const a3_SpatialPoseDQ *spatialPose0, const a3_SpatialPoseDQ *spatialPose1, const a3real u);
+
+// interpolate single node dual quaternion poses along the screw (exact)
+a3i32 a3spatialPoseDQSclerp(a3_SpatialPoseDQ *spatialPose_out, const a3_SpatialPoseDQ *spatialPose0, const a3_SpatialPoseDQ *spatialPose1, const a3real u);
+
+// weighted dual linear blend of several dual quaternion poses selected by 
+//	index (e.g. skinning influences of one vertex)
+a3i32 a3spatialPoseDQBlend(a3_SpatialPoseDQ *spatialPose_out, const a3_SpatialPoseDQ *spatialPoses, const a3ui32 *index, const a3real *weight, const a3ui32 count);
+
+// restore single node pose from matrix (inverse of convert); assumes the 
+//	matrix is affine with positive scale and no shear
+a3i32 a3spatialPoseRestore(a3_SpatialPose *spatialPose_out, const a3mat4 *mat_in);
+
+// concatenate (combine) two single node poses: rotations multiply, 
+//	scales multiply, translations add; channels not in use are left as-is
+a3i32 a3spatialPoseConcat(a3_SpatialPose *spatialPose_out, const a3_SpatialPose *spatialPose_lhs, const a3_SpatialPose *spatialPose_rhs, const a3_SpatialPoseChannel channel);
+
+// interpolate between two single node poses; channels not in use are left as-is
+a3i32 a3spatialPoseLerp(a3_SpatialPose *spatialPose_out, const a3_SpatialPose *spatialPose0, const a3_SpatialPose *spatialPose1, const a3real u, const a3_SpatialPoseChannel channel);
+
+
+//-----------------------------------------------------------------------------
+
+// get number of blocks needed to hold a number of poses
+a3i32 a3spatialPoseBlockGetCount(const a3ui32 count);
+
+// transpose poses into blocks; the unused end of the last block is reset
+a3i32 a3spatialPoseBlockPack(a3_SpatialPoseBlock *blocks_out, const a3_SpatialPose *spatialPoses_in, const a3ui32 count);
+
+// transpose blocks back into poses
+a3i32 a3spatialPoseBlockUnpack(a3_SpatialPose *spatialPoses_out, const a3_SpatialPoseBlock *blocks_in, const a3ui32 count);
+
+// convert a batch of poses to matrices, a block at a time; all channels are 
+//	converted (channels not in use should hold identity values)
+a3i32 a3spatialPoseConvertBatch(a3mat4 *matrices_out, const a3_SpatialPoseBlock *spatialPoses_in, const a3ui32 count);
+
+// scalar reference for batch conversion; produces the same results
+a3i32 a3spatialPoseConvertBatchScalar(a3mat4 *matrices_out, const a3_SpatialPoseBlock *spatialPoses_in, const a3ui32 count);
+
+// encode single node pose in compact form; scale is stored as one uniform 
+//	value, so non-uniform scale is lossy: the mean of the three axes is 
+//	stored and the function returns 0 (1 if scale was uniform)
+a3i32 a3spatialPoseEncode(a3_SpatialPoseCompact *spatialPose_out, const a3_SpatialPose *spatialPose_in);
+
+// decode single node pose from compact form; same operations in the same 
+//	order as the batch decode, so both give identical results
+a3i32 a3spatialPoseDecode(a3_SpatialPose *spatialPose_out, const a3_SpatialPoseCompact *spatialPose_in);
+
+// decode a batch of compact poses, a block at a time; the unused end of the 
+//	last block is reset
+a3i32 a3spatialPoseDecodeBatch(a3_SpatialPoseBlock *spatialPoses_out, const a3_SpatialPoseCompact *spatialPoses_in, const a3ui32 count);
+
+// restore a batch of poses from matrices, a block at a time; the unused end 
+//	of the last block is reset
+a3i32 a3spatialPoseRestoreBatch(a3_SpatialPoseBlock *spatialPoses_out, const a3mat4 *matrices_in, const a3ui32 count);
+
+// scalar reference for batch restore; matches to rounding of square roots
+a3i32 a3spatialPoseRestoreBatchScalar(a3_SpatialPoseBlock *spatialPoses_out, const a3mat4 *matrices_in, const a3ui32 count);
 
 
 //-----------------------------------------------------------------------------